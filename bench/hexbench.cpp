@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <cctype>
+#include <string>
+
+#include "ocra/hex.hpp"
+
+
+namespace
+{
+std::string Hex(std::size_t length)
+{
+    constexpr char CHARACTERS[] = "0123456789abcdefABCDEF";
+    auto result = std::string(length, '0');
+    for (auto i = 0u; i < length; ++i)
+        result[i] = CHARACTERS[(i * 5u + i / 7u) % 22u];
+    return result;
+}
+
+// Character by character decoding, the one used before the vectorized decoder
+bool CharacterDecode(uint8_t* output, const char* input, std::size_t length)
+{
+    for (auto i = 0u; i < length; ++i)
+    {
+        const auto& c = toupper(input[i]);
+        if ('0' <= c  && c <= '9')
+            output[i / 2] |= (c - '0');
+        else if ('A' <= c  && c <= 'F')
+            output[i / 2] |= (10 + c - 'A');
+        else
+            return false;
+
+        if (!(i % 2))
+            output[i / 2] <<= 4;
+    }
+    return true;
+}
+}  // namespace
+
+
+void HexCharacterDecode(benchmark::State& state)
+{
+    const auto hex = Hex(state.range(0));
+    uint8_t output[512] = {};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(CharacterDecode(output, hex.data(), hex.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * hex.size());
+}
+BENCHMARK(HexCharacterDecode)->RangeMultiplier(4)->Range(32, 512);
+
+void HexDecode(benchmark::State& state)
+{
+    const auto hex = Hex(state.range(0));
+    uint8_t output[512];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ocra::DecodeHex(hex, output));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * hex.size());
+}
+BENCHMARK(HexDecode)->RangeMultiplier(4)->Range(32, 512);
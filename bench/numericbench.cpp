@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ocra/numeric.hpp"
+
+
+namespace
+{
+std::string Question(std::size_t digits, std::size_t seed = 0u)
+{
+    auto result = std::string(digits, '0');
+    for (auto i = 0u; i < digits; ++i)
+        result[i] = static_cast<char>('1' + (i * 7u + seed * 3u) % 9u);
+    return result;
+}
+
+// The encoding before the limb encoder: long division to a hex string, then hex to bytes
+std::size_t LongDivisionEncode(const std::string& decimal, uint8_t* output)
+{
+    char x[256] = {};
+    std::size_t l = 0;
+    for (const auto c : decimal)
+    {
+        div_t d = {};
+        d.quot = c - '0';
+        for (std::size_t i = 0; i < l; ++i)
+        {
+            d = div(x[i] * 10 + d.quot, 16);
+            x[i] = d.rem;
+        }
+        if (d.quot)
+            x[l++] = d.quot;
+    }
+
+    auto hex = std::string(l, '0');
+    for (auto i = 0u; i < l; ++i)
+        hex[i] = x[l - 1 - i] + (10 <= x[l - 1 - i] ? 'A' - 10 : '0');
+
+    for (auto i = 0u; i < hex.size(); ++i)
+    {
+        const auto nibble = hex[i] <= '9' ? hex[i] - '0' : hex[i] - 'A' + 10;
+        output[i / 2] = i % 2 ? output[i / 2] | nibble : nibble << 4;
+    }
+    return (hex.size() + 1u) / 2u;
+}
+}  // namespace
+
+
+void NumericQuestionLongDivision(benchmark::State& state)
+{
+    const auto question = Question(state.range(0));
+    uint8_t output[128];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(LongDivisionEncode(question, output));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(NumericQuestionLongDivision)->RangeMultiplier(2)->Range(8, 64);
+
+void NumericQuestion(benchmark::State& state)
+{
+    const auto question = Question(state.range(0));
+    uint8_t output[128];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ocra::EncodeNumericQuestion(question, output, sizeof(output)));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(NumericQuestion)->RangeMultiplier(2)->Range(8, 64);
+
+void NumericQuestionBatch(benchmark::State& state)
+{
+    constexpr auto COUNT = 1024u;
+    auto questions = std::vector<std::string>(COUNT);
+    auto views = std::vector<std::string_view>(COUNT);
+    for (auto i = 0u; i < COUNT; ++i)
+    {
+        questions[i] = Question(state.range(0), i);
+        views[i] = questions[i];
+    }
+
+    auto output = std::vector<uint8_t>(COUNT * 32u);
+    auto sizes = std::vector<std::size_t>(COUNT);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ocra::EncodeNumericQuestions(views, output.data(), 32u, sizes));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+BENCHMARK(NumericQuestionBatch)->RangeMultiplier(2)->Range(8, 64);
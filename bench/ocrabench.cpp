@@ -0,0 +1,234 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/message.hpp"
+#include "ocra/ocra.hpp"
+#include "ocra/provider.hpp"
+#include "perfcounters.hpp"
+
+
+namespace
+{
+// Suites of the RFC6287 test vectors (see 'ocratest.cpp')
+const char* const RFC_SUITES[] = {
+    "OCRA-1:HOTP-SHA1-6:QN08",
+    "OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1",
+    "OCRA-1:HOTP-SHA256-8:QN08-PSHA1",
+    "OCRA-1:HOTP-SHA512-8:C-QN08",
+    "OCRA-1:HOTP-SHA512-8:QN08-T1M",
+    "OCRA-1:HOTP-SHA256-8:QA08",
+    "OCRA-1:HOTP-SHA512-8:QA08",
+    "OCRA-1:HOTP-SHA512-8:QA08-PSHA1",
+    "OCRA-1:HOTP-SHA512-8:QA10-T1M",
+};
+
+// Validation of the short, the longest and the mixed case suites
+const char* const VALIDATED_SUITES[] = {
+    "OCRA-1:HOTP-SHA1-6:QN08",
+    "OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1",
+    "OCRA-1:HOTP-SHA512-10:C-QH64-PSHA512-S512-T48H",
+    "ocra-1:hotp-sha512-8:qa10-t1m",
+};
+
+const auto SHA1_KEY = "3132333435363738393031323334353637383930";
+const auto SHA256_KEY = "3132333435363738393031323334353637383930313233343536373839303132";
+const auto SHA512_KEY = "3132333435363738393031323334353637383930313233343536373839303132"
+                        "3334353637383930313233343536373839303132333435363738393031323334";
+
+ocra::OcraParameters Parameters(const ocra::Ocra& ocra)
+{
+    const auto hmac = ocra.Suite().hmac;
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex(hmac == ocra::OcraHmac::HOTP_SHA1 ? SHA1_KEY :
+                    hmac == ocra::OcraHmac::HOTP_SHA256 ? SHA256_KEY : SHA512_KEY, parameters.key);
+    parameters.counter = 1u;
+    parameters.timestamp = 0x132d0b6;
+    parameters.password = "1234";
+    parameters.question = ocra.Suite().challenge.format == 'A' ? "SIG10000" : "12345678";
+    return parameters;
+}
+
+// Backends of the provider hooks, the argument of the benchmarks
+const ocra::HashProvider& Backend(int64_t index, ocra::OcraHmac hmac)
+{
+    return index ? ocra::BuiltinProvider(hmac) : ocra::UserFunctionProvider(hmac);
+}
+
+const char* BackendName(int64_t index)
+{
+    return index ? "builtin" : "user_implemented";
+}
+
+// Built-in engine behind a boundary with a round trip of 'crossing' per call, as a signing module
+class CrossingProvider : public ocra::HashProvider
+{
+public:
+    CrossingProvider(ocra::OcraHmac hmac, std::chrono::nanoseconds crossing)
+        : m_provider{ocra::BuiltinProvider(hmac)}
+        , m_crossing{crossing}
+    {}
+
+    bool Init(State& state, ocra::Span<const uint8_t> key) const override { return m_provider.Init(state, key); }
+    void Update(State& state, ocra::Span<const uint8_t> data) const override { m_provider.Update(state, data); }
+
+    bool Final(State& state, ocra::Span<uint8_t> digest) const override
+    {
+        Cross();
+        return m_provider.Final(state, digest);
+    }
+
+    bool Batch(std::size_t count, const ocra::Span<const uint8_t>* keys,
+               const ocra::Span<const uint8_t>* messages, const ocra::Span<uint8_t>* digests) const override
+    {
+        Cross();
+        return m_provider.Batch(count, keys, messages, digests);
+    }
+
+private:
+    void Cross() const
+    {
+        const auto end = std::chrono::steady_clock::now() + m_crossing;
+        while (std::chrono::steady_clock::now() < end) {}
+    }
+
+private:
+    const ocra::HashProvider& m_provider;
+    std::chrono::nanoseconds m_crossing;
+};
+}  // namespace
+
+
+void SuiteValidate(benchmark::State& state)
+{
+    const auto suite = std::string(VALIDATED_SUITES[state.range(0)]);
+    auto ocra = ocra::Ocra{};
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+    {
+        ocra.From(suite);
+        benchmark::DoNotOptimize(ocra.Plan());
+    }
+    counters.Stop();
+    counters.Report(state);
+    state.SetLabel(suite);
+}
+BENCHMARK(SuiteValidate)->DenseRange(0, std::size(VALIDATED_SUITES) - 1);
+
+// The function call operator: input checks, message assembly, HMAC of the provider and
+// the truncation, with the provider of the same backend for the password hash
+void RfcSuiteCall(benchmark::State& state)
+{
+    auto ocra = ocra::Ocra(RFC_SUITES[state.range(0)]);
+    const auto parameters = Parameters(ocra);
+    ocra::RegisterProvider(ocra.Suite().hmac, &Backend(state.range(1), ocra.Suite().hmac));
+    ocra::RegisterProvider(ocra::OcraSha::SHA1,
+                           state.range(1) ? &ocra::BuiltinProvider(ocra::OcraSha::SHA1) : nullptr);
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ocra(parameters));
+    counters.Stop();
+    counters.Report(state);
+
+    ocra::RegisterProvider(ocra.Suite().hmac, nullptr);
+    ocra::RegisterProvider(ocra::OcraSha::SHA1, nullptr);
+    state.SetLabel(std::string(RFC_SUITES[state.range(0)]) + " " + BackendName(state.range(1)));
+}
+BENCHMARK(RfcSuiteCall)->ArgsProduct({benchmark::CreateDenseRange(0, std::size(RFC_SUITES) - 1, 1), {0, 1}});
+
+// The message assembly alone, the input checks and the 'Concatenate' steps of the suite
+void RfcSuiteAssemble(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra(RFC_SUITES[state.range(0)]);
+    const auto parameters = Parameters(ocra);
+    const auto& plan = ocra.Plan();
+    uint8_t message[ocra::EvaluationPlan::MAX_LENGTH];
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(plan.assemble(plan, message, parameters, ocra::BuiltinPasswordHash));
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state);
+    state.SetLabel(RFC_SUITES[state.range(0)]);
+}
+BENCHMARK(RfcSuiteAssemble)->DenseRange(0, std::size(RFC_SUITES) - 1);
+
+// The hot path of the same suites, prepared key and the built-in engine
+void RfcSuiteCompute(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra(RFC_SUITES[state.range(0)]);
+    const auto parameters = Parameters(ocra);
+    const auto key = ocra.Prepare(parameters.key);
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ocra.Compute(parameters, key));
+    counters.Stop();
+    counters.Report(state);
+    state.SetLabel(RFC_SUITES[state.range(0)]);
+}
+BENCHMARK(RfcSuiteCompute)->DenseRange(0, std::size(RFC_SUITES) - 1);
+
+// A message of the given length streamed through a provider backend
+void ProviderHmac(benchmark::State& state)
+{
+    const auto& provider = Backend(state.range(1), ocra::OcraHmac::HOTP_SHA256);
+    const auto key = std::vector<uint8_t>(32u, 0x31);
+    const auto message = std::vector<uint8_t>(state.range(0), 0x5a);
+    uint8_t digest[32];
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+    {
+        ocra::HashProvider::State context;
+        provider.Init(context, key);
+        provider.Update(context, message);
+        benchmark::DoNotOptimize(provider.Final(context, {digest, sizeof(digest)}));
+    }
+    counters.Stop();
+    counters.Report(state);
+    state.SetBytesProcessed(state.iterations() * message.size());
+    state.SetLabel(BackendName(state.range(1)));
+}
+BENCHMARK(ProviderHmac)->ArgsProduct({{64, 256, 1024}, {0, 1}});
+
+// 64 requests through a provider with a 2us round trip, one call per request or the batch
+// operator() with one call for all of them
+void ProviderBatchCall(benchmark::State& state)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    const auto provider = CrossingProvider(ocra.Suite().hmac, std::chrono::microseconds(2));
+    ocra::RegisterProvider(ocra.Suite().hmac, &provider);
+    auto parameters = std::vector<ocra::OcraParameters>(64u, Parameters(ocra));
+    for (auto i = 0u; i < parameters.size(); ++i)
+        parameters[i].counter = i;
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+
+    auto counters = bench::PerfCounters{};
+    counters.Start();
+    for (auto _ : state)
+    {
+        if (state.range(0))
+            benchmark::DoNotOptimize(ocra(parameters, results));
+        else
+        {
+            for (const auto& request : parameters)
+                benchmark::DoNotOptimize(ocra(request));
+        }
+    }
+    counters.Stop();
+    counters.Report(state);
+
+    ocra::RegisterProvider(ocra.Suite().hmac, nullptr);
+    state.SetItemsProcessed(state.iterations() * parameters.size());
+    state.SetLabel(state.range(0) ? "batch" : "per message");
+}
+BENCHMARK(ProviderBatchCall)->Arg(0)->Arg(1);
@@ -0,0 +1,138 @@
+#include "perfcounters.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace bench
+{
+namespace
+{
+constexpr const char* NAMES[PerfCounters::EVENTS] = {"cycles", "instructions", "branch-misses", "cache-misses"};
+
+#ifdef __linux__
+constexpr uint64_t CONFIGS[PerfCounters::EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+
+int Open(uint64_t config)
+{
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+// Count scaled by the time the event was not scheduled on the PMU (multiplexing)
+uint64_t Read(int descriptor)
+{
+    uint64_t values[3] = {};
+    if (read(descriptor, values, sizeof(values)) != sizeof(values) || !values[2])
+        return 0u;
+    return values[2] == values[1] ? values[0] :
+        static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+}
+#endif
+
+// Reported once per process, every benchmark tries to open the events again
+void ReportUnavailable(const char* name, int error)
+{
+    static bool isReported[PerfCounters::EVENTS] = {};
+    for (auto i = 0u; i < PerfCounters::EVENTS; ++i)
+    {
+        if (NAMES[i] == name && !isReported[i])
+        {
+            isReported[i] = true;
+            fprintf(stderr, "OCRA_BENCH_PERF: '%s' unavailable (%s), not reported\n", name, strerror(error));
+        }
+    }
+}
+}  // namespace
+
+
+bool PerfCounters::IsEnabled()
+{
+    static const bool isEnabled = [] {
+        const auto* value = getenv("OCRA_BENCH_PERF");
+        return value && *value && strcmp(value, "0") != 0;
+    }();
+    return isEnabled;
+}
+
+PerfCounters::PerfCounters()
+{
+    for (auto i = 0u; i < EVENTS; ++i)
+    {
+        m_descriptors[i] = -1;
+        if (!IsEnabled())
+            continue;
+        #ifdef __linux__
+        m_descriptors[i] = Open(CONFIGS[i]);
+        if (m_descriptors[i] < 0)
+            ReportUnavailable(NAMES[i], errno);
+        #else
+        ReportUnavailable(NAMES[i], ENOSYS);
+        #endif
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    #ifdef __linux__
+    for (const auto descriptor : m_descriptors)
+        if (descriptor >= 0)
+            close(descriptor);
+    #endif
+}
+
+void PerfCounters::Start()
+{
+    #ifdef __linux__
+    for (const auto descriptor : m_descriptors)
+    {
+        if (descriptor >= 0)
+        {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    #endif
+}
+
+void PerfCounters::Stop()
+{
+    #ifdef __linux__
+    for (auto i = 0u; i < EVENTS; ++i)
+    {
+        if (m_descriptors[i] >= 0)
+        {
+            ioctl(m_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+            m_values[i] = Read(m_descriptors[i]);
+        }
+    }
+    #endif
+}
+
+void PerfCounters::Report(benchmark::State& state) const
+{
+    for (auto i = 0u; i < EVENTS; ++i)
+        if (m_descriptors[i] >= 0)
+            state.counters[NAMES[i]] = benchmark::Counter(static_cast<double>(m_values[i]),
+                                                          benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace bench
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+
+#include <benchmark/benchmark.h>
+
+
+namespace bench
+{
+// Hardware counters of the benchmark thread, read around the timed loop when the
+// OCRA_BENCH_PERF environment variable is set:
+//     auto counters = bench::PerfCounters{};
+//     counters.Start();
+//     for (auto _ : state) ...
+//     counters.Stop();
+//     counters.Report(state);
+// Reports cycles, instructions, branch-misses and cache-misses per iteration (one OTP).
+// The events which cannot be opened (no perf_event_open in a container, perf_event_paranoid,
+// other systems) are left out of the report, then the benchmark runs as without the mode
+class PerfCounters
+{
+public:
+    static constexpr std::size_t EVENTS = 4u;
+
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    static bool IsEnabled();
+
+    void Start();
+    void Stop();
+    void Report(benchmark::State& state) const;
+
+private:
+    int m_descriptors[EVENTS];
+    uint64_t m_values[EVENTS] = {};
+};
+
+}  // namespace bench
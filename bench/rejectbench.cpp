@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ocra/hex.hpp"
+#include "ocra/ocra.hpp"
+
+
+namespace
+{
+ocra::OcraParameters Parameters(std::string question)
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930", parameters.key);
+    parameters.question = std::move(question);
+    return parameters;
+}
+}  // namespace
+
+
+// Accepted request, the reference for the rejected ones
+static void RequestAccepted(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    const auto parameters = Parameters("12345678");
+    const auto key = ocra.Prepare(parameters.key);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ocra.TryCompute(parameters, key));
+}
+BENCHMARK(RequestAccepted);
+
+// Question of a numeric suite with letters (0x15)
+static void RequestRejectedByCode(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    const auto parameters = Parameters("1234567x");
+    const auto key = ocra.Prepare(parameters.key);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ocra.TryCompute(parameters, key));
+}
+BENCHMARK(RequestRejectedByCode);
+
+#ifndef OCRA_NO_THROW
+static void RequestRejectedByException(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    const auto parameters = Parameters("1234567x");
+    const auto key = ocra.Prepare(parameters.key);
+    for (auto _ : state)
+    {
+        try
+        {
+            benchmark::DoNotOptimize(ocra.Compute(parameters, key));
+        }
+        catch (const std::invalid_argument& e)
+        {
+            benchmark::DoNotOptimize(e.what());
+        }
+    }
+}
+BENCHMARK(RequestRejectedByException);
+#endif
@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/ocra.hpp"
+#include "runtime/async.hpp"
+#include "runtime/batch.hpp"
+#include "runtime/pipeline.hpp"
+#include "runtime/scheduler.hpp"
+#include "runtime/threadpool.hpp"
+
+
+namespace
+{
+constexpr auto REQUESTS = 16384u;
+
+std::vector<ocra::OcraParameters> Requests()
+{
+    auto parameters = std::vector<ocra::OcraParameters>(REQUESTS);
+    for (auto i = 0u; i < parameters.size(); ++i)
+    {
+        ocra::DecodeHex("3132333435363738393031323334353637383930313233343536373839303132", parameters[i].key);
+        parameters[i].key[0] = static_cast<uint8_t>(i);
+        parameters[i].counter = i;
+        parameters[i].question = "12345678";
+    }
+    return parameters;
+}
+}  // namespace
+
+
+// Batch of requests with own keys on the given number of workers, 1 is the sequential batch
+static void BatchEvaluatorThroughput(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    const auto parameters = Requests();
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    auto pool = ocra::runtime::ThreadPool(state.range(0));
+    const auto evaluator = ocra::runtime::BatchEvaluator(pool);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(evaluator.Compute(ocra, parameters, results));
+    state.SetItemsProcessed(state.iterations() * parameters.size());
+}
+BENCHMARK(BatchEvaluatorThroughput)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+// Single requests of the given number of producers through the stages, the lanes
+// of the hash stage are filled by all of them
+static void PipelineThroughput(benchmark::State& state)
+{
+    const auto producers = static_cast<std::size_t>(state.range(0));
+    const auto parameters = Requests();
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(parameters.size());
+    for (auto i = 0u; i < requests.size(); ++i)
+        requests[i].parameters = parameters[i];
+
+    auto pipeline = ocra::runtime::Pipeline(ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08"));
+    for (auto _ : state)
+    {
+        auto threads = std::vector<std::thread>{};
+        for (auto p = 0u; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]() {
+                for (auto i = p; i < requests.size(); i += producers)
+                    while (!pipeline.TrySubmit(requests[i]))
+                        std::this_thread::yield();
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (const auto& request : requests)
+            while (!request.IsDone())
+                std::this_thread::yield();
+    }
+
+    const auto statistics = pipeline.Statistics();
+    state.counters["lanes"] = statistics.batches ? static_cast<double>(statistics.hashed) / statistics.batches : 0.0;
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(PipelineThroughput)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+// Verifications of the given number of producers, each waiting for its request, gathered by the
+// scheduler with the given 'maxWait' (microseconds). The wait quantiles and the mean batch are
+// the tradeoff of the setting
+static void SchedulerVerify(benchmark::State& state)
+{
+    const auto producers = static_cast<std::size_t>(state.range(1));
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto parameters = Requests();
+    parameters.resize(REQUESTS / 8u);
+    auto responses = std::vector<std::string>(parameters.size());
+    auto requests = std::vector<ocra::runtime::VerifyRequest>(parameters.size());
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        responses[i] = std::string(ocra.Compute(parameters[i]).View());
+        requests[i].parameters = parameters[i];
+        requests[i].response = responses[i];
+    }
+
+    auto options = ocra::runtime::SchedulerOptions{};
+    options.maxWait = std::chrono::microseconds(state.range(0));
+    auto scheduler = ocra::runtime::BatchScheduler(ocra, options);
+    for (auto _ : state)
+    {
+        auto threads = std::vector<std::thread>{};
+        for (auto p = 0u; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]() {
+                for (auto i = p; i < requests.size(); i += producers)
+                {
+                    scheduler.Submit(requests[i]);
+                    while (!requests[i].IsDone())
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    const auto statistics = scheduler.Statistics();
+    state.counters["batch"] = static_cast<double>(statistics.requests) / statistics.batches;
+    state.counters["wait_p50_us"] = ocra::runtime::SchedulerStatistics::Quantile(statistics.waits, 0.5);
+    state.counters["wait_p99_us"] = ocra::runtime::SchedulerStatistics::Quantile(statistics.waits, 0.99);
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(SchedulerVerify)->ArgsProduct({{0, 100, 1000}, {4, 16}})->UseRealTime();
+
+namespace
+{
+// Signer answering after 'latency', up to 16 requests at once
+class SlowSigner : public ocra::runtime::AsyncHashProvider
+{
+public:
+    explicit SlowSigner(std::chrono::microseconds latency) : m_latency{latency} {}
+
+    void Hmac(ocra::OcraHmac hmac, ocra::Span<const uint8_t> key, ocra::Span<const uint8_t> message,
+              ocra::Span<uint8_t> digest, Done done) const override
+    {
+        m_signer.Post([=]() {
+            std::this_thread::sleep_for(m_latency);
+            auto context = ocra::hash::HmacContext(static_cast<ocra::hash::Algorithm>(hmac), key.data(), key.size());
+            context.Update(message.data(), message.size());
+            context.Final(digest.data());
+            done(true);
+        });
+    }
+
+private:
+    std::chrono::microseconds m_latency;
+    mutable ocra::runtime::ThreadExecutor m_signer{16u};
+};
+}  // namespace
+
+// Requests in flight at once on one executor thread, with a signer of 200 us latency
+static void AsyncComputeInFlight(benchmark::State& state)
+{
+    const auto parameters = Requests();
+    const auto inFlight = static_cast<std::size_t>(state.range(0));
+    auto executor = ocra::runtime::ThreadExecutor(1u);
+    const auto signer = SlowSigner(std::chrono::microseconds(200));
+    const auto async = ocra::runtime::AsyncOcra(ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08"), executor, &signer);
+    for (auto _ : state)
+    {
+        auto done = std::atomic<std::size_t>{};
+        for (auto i = 0u; i < inFlight; ++i)
+            async.ComputeAsync(parameters[i], [&](const ocra::OtpResult&) { ++done; });
+        while (done.load() < inFlight)
+            std::this_thread::yield();
+    }
+    state.SetItemsProcessed(state.iterations() * inFlight);
+}
+BENCHMARK(AsyncComputeInFlight)->Arg(1)->Arg(16)->Arg(64)->UseRealTime();
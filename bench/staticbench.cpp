@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/staticocra.hpp"
+
+
+namespace
+{
+constexpr char SHA1_QN08[] = "OCRA-1:HOTP-SHA1-6:QN08";
+constexpr char SHA256_C_QN08_PSHA1[] = "OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1";
+constexpr char SHA512_QA10_T1M[] = "OCRA-1:HOTP-SHA512-8:QA10-T1M";
+
+ocra::OcraParameters Parameters()
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930313233343536373839303132", parameters.key);
+    parameters.counter = 1u;
+    parameters.timestamp = 0x132d0b6;
+    parameters.password = "1234";
+    parameters.question = "12345678";
+    return parameters;
+}
+}  // namespace
+
+
+template <const char* SUITE>
+void RuntimeSuite(benchmark::State& state)
+{
+    const auto ocra = ocra::Ocra(SUITE);
+    const auto parameters = Parameters();
+    const auto key = ocra.Prepare(parameters.key);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ocra.Compute(parameters, key));
+}
+BENCHMARK_TEMPLATE(RuntimeSuite, SHA1_QN08);
+BENCHMARK_TEMPLATE(RuntimeSuite, SHA256_C_QN08_PSHA1);
+BENCHMARK_TEMPLATE(RuntimeSuite, SHA512_QA10_T1M);
+
+template <const char* SUITE>
+void StaticSuite(benchmark::State& state)
+{
+    using Static = ocra::StaticOcra<SUITE>;
+    const auto parameters = Parameters();
+    const auto key = Static::Prepare(parameters.key);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Static::Compute(parameters, key));
+}
+BENCHMARK_TEMPLATE(StaticSuite, SHA1_QN08);
+BENCHMARK_TEMPLATE(StaticSuite, SHA256_C_QN08_PSHA1);
+BENCHMARK_TEMPLATE(StaticSuite, SHA512_QA10_T1M);
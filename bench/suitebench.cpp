@@ -0,0 +1,240 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ocra/suiteparser.hpp"
+
+
+namespace
+{
+// The validation before the string_view parser: in place uppercase, recursive split into
+// std::string parts and the parts passed by value, with failure codes instead of exceptions
+class LegacyParser
+{
+public:
+    int Parse(std::string suite)
+    {
+        m_suite = ocra::OcraSuite{};
+        for (auto& c : suite)
+            c = toupper(c);
+
+        auto [data, size] = split<3>(suite, ':');
+        if (size != 3u)
+            return 0x01;
+        if (data[0] != "OCRA-1")
+            return 0x02;
+        m_suite.version = ocra::OcraVersion::OCRA_1;
+
+        if (const auto status = ParseCryptoFunction(std::move(data[1])))
+            return status;
+        return ParseDataInput(std::move(data[2]));
+    }
+
+private:
+    int ParseCryptoFunction(std::string function)
+    {
+        auto [data, size] = split<3>(std::move(function), '-');
+        auto algorithm = std::move(data[0]);
+        auto hashFunc = std::move(data[1]);
+        auto digits = std::move(data[2]);
+        if (size != 3u)
+            return 0x03;
+        if (algorithm != "HOTP")
+            return 0x04;
+
+        if (hashFunc == "SHA1")
+            m_suite.hmac = ocra::OcraHmac::HOTP_SHA1;
+        else if (hashFunc == "SHA256")
+            m_suite.hmac = ocra::OcraHmac::HOTP_SHA256;
+        else if (hashFunc == "SHA512")
+            m_suite.hmac = ocra::OcraHmac::HOTP_SHA512;
+        else
+            return 0x05;
+
+        if (digits == "0" || digits == "4" || digits == "5" || digits == "6" ||
+            digits == "7" || digits == "8" || digits == "9" || digits == "10")
+            m_suite.digits = static_cast<ocra::OcraDigits>(atoi(digits.c_str()));
+        else
+            return 0x06;
+        return 0;
+    }
+
+    int ParseChallenge(std::string challenge)
+    {
+        challenge.erase(0, 1);
+        if (challenge.size() != 3)
+            return 0x07;
+        m_suite.challenge.format = challenge.front();
+        if (challenge.front() != 'A' && challenge.front() != 'N' && challenge.front() != 'H')
+            return 0x08;
+        challenge.erase(0, 1);
+        m_suite.challenge.length = atoi(challenge.c_str());
+        return (m_suite.challenge.length < 4 || 64 < m_suite.challenge.length) ? 0x09 : 0;
+    }
+
+    int ParsePassword(std::string password)
+    {
+        password.erase(0, 1);
+        if (password == "SHA1")
+            m_suite.passwordSha = ocra::OcraSha::SHA1;
+        else if (password == "SHA256")
+            m_suite.passwordSha = ocra::OcraSha::SHA256;
+        else if (password == "SHA512")
+            m_suite.passwordSha = ocra::OcraSha::SHA512;
+        else
+            return 0x0A;
+        return 0;
+    }
+
+    int ParseSession(std::string session)
+    {
+        session.erase(0, 1);
+        if (session.size() != 3)
+            return 0x0B;
+        m_suite.sessionLength = atoi(session.c_str());
+        return (m_suite.sessionLength < 1 || 512 < m_suite.sessionLength) ? 0x0C : 0;
+    }
+
+    int ParseTimestamp(std::string timestamp)
+    {
+        timestamp.erase(0, 1);
+        if (timestamp.size() < 2 || 3 < timestamp.size())
+            return 0x0D;
+        m_suite.timestamp.step = timestamp.back();
+        if (timestamp.back() != 'S' && timestamp.back() != 'M' && timestamp.back() != 'H')
+            return 0x0E;
+        timestamp.pop_back();
+        m_suite.timestamp.time = atoi(timestamp.c_str());
+        const auto step = m_suite.timestamp.step;
+        const auto time = m_suite.timestamp.time;
+        return ((step == 'S' || step == 'M') && (time < 1 || 59 < time)) ? 0x0F : 0;
+    }
+
+    // Each part is copied into the Parse* functions as the former Insert*InputData did
+    int ParseDataInput(std::string dataInput)
+    {
+        auto input = 0u;
+        auto [data, size] = split<5>(std::move(dataInput), '-');
+
+        auto counter = data[input];
+        if (counter.empty())
+            return 0x1B;
+        if (counter[0] == 'C')
+        {
+            m_suite.isCounter = true;
+            ++input;
+        }
+
+        auto challenge = data[input];
+        if (challenge.empty())
+            return 0x1C;
+        if (challenge[0] != 'Q')
+            return 0x1D;
+        if (const auto status = ParseChallenge(std::move(challenge)))
+            return status;
+        ++input;
+
+        if (auto password = data[input]; !password.empty() && password[0] == 'P')
+        {
+            if (const auto status = ParsePassword(std::move(password)))
+                return status;
+            ++input;
+        }
+        if (auto session = data[input]; !session.empty() && session[0] == 'S')
+        {
+            if (const auto status = ParseSession(std::move(session)))
+                return status;
+            ++input;
+        }
+        if (auto timestamp = data[input]; !timestamp.empty() && timestamp[0] == 'T')
+        {
+            if (const auto status = ParseTimestamp(std::move(timestamp)))
+                return status;
+            ++input;
+        }
+        return input != size ? 0x1E : 0;
+    }
+
+    template <std::size_t N, typename T>
+    std::pair<std::array<std::string, N>, std::size_t> split(T&& data, char delimiter) const
+    {
+        auto result = std::array<std::string, N>{};
+        auto status = split<0>(result, data.c_str(), delimiter);
+        return std::make_pair(result, status);
+    }
+
+    template <std::size_t M, std::size_t N>
+    std::size_t split(std::array<std::string, N>& result, const char* data, char delimiter) const
+    {
+        if constexpr (M >= N)
+            return M + 1;
+        else if (data[0] == '\0')
+            return M + 1;
+        else
+        {
+            auto i = 0u;
+            while (data[i] != delimiter && data[i] != '\0') ++i;
+            result[M] = std::string(data, i);
+            if (data[i] == '\0')
+                return M + 1;
+            i += (data[i] == delimiter);
+            return split<M + 1>(result, data + i, delimiter);
+        }
+    }
+
+private:
+    ocra::OcraSuite m_suite;
+};
+
+
+// Every valid combination of the suite parts, with the bounds of the numeric values
+std::vector<std::string> ValidSuites()
+{
+    auto result = std::vector<std::string>{};
+    for (const auto* function : {"HOTP-SHA1", "HOTP-SHA256", "HOTP-SHA512"})
+        for (const auto* digits : {"0", "4", "5", "6", "7", "8", "9", "10"})
+            for (const auto* counter : {"", "C-"})
+                for (const auto* format : {"A", "N", "H"})
+                    for (const auto* length : {"04", "64"})
+                        for (const auto* password : {"", "-PSHA1", "-PSHA256", "-PSHA512"})
+                            for (const auto* session : {"", "-S001", "-S512"})
+                                for (const auto* timestamp : {"", "-T1S", "-T59M", "-T0H", "-T48H"})
+                                {
+                                    result.push_back(std::string("ocra-1:") + function + '-' + digits + ':' +
+                                                     counter + 'Q' + format + length + password +
+                                                     session + timestamp);
+                                }
+    return result;
+}
+}  // namespace
+
+
+void SuiteParseLegacy(benchmark::State& state)
+{
+    const auto suites = ValidSuites();
+    auto parser = LegacyParser{};
+    for (auto _ : state)
+    {
+        for (const auto& suite : suites)
+            benchmark::DoNotOptimize(parser.Parse(suite));
+    }
+    state.SetItemsProcessed(state.iterations() * suites.size());
+}
+BENCHMARK(SuiteParseLegacy);
+
+void SuiteParse(benchmark::State& state)
+{
+    const auto suites = ValidSuites();
+    for (auto _ : state)
+    {
+        for (const auto& suite : suites)
+            benchmark::DoNotOptimize(ocra::ParseSuite(suite));
+    }
+    state.SetItemsProcessed(state.iterations() * suites.size());
+}
+BENCHMARK(SuiteParse);
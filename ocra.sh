@@ -8,13 +8,14 @@ help() {
    echo "Run script for your projects"
    echo "To change project output file name just change the name of this file"
    echo
-   echo "Syntax: run.sh [-h|i|c|t|t|d|k|[g|f <options>...]]"
+   echo "Syntax: run.sh [-h|i|c|t|t|d|k|b|[g|f <options>...]]"
    echo "Options:"
    echo "h              Print this help"
    echo "c              Clean project before build"
    echo "t              Run tests for the project"
    echo "d              Run tests under GDB"
    echo "k              Run tests without the project and tests rebuild"
+   echo "b              Run benchmarks (Google Benchmark), results in 'build/<name>-bench.json'"
    echo "g <options>... Run tests with the gtest options, specify the options after the flag"
    echo "f <options>... Run tests with additional CMAKE flags, specify the options after the flag"
    echo "               example, './run.sh -g --gtest_filter=ExampleTest.*'"
@@ -48,6 +49,18 @@ build() {
     ./${PROJECT_NAME}
 }
 
+benchrun() {
+    echo "[ BUILD ] Build project benchmarks"
+    if [[ ! -d "./build" ]]; then
+        mkdir build
+    fi
+    cd build
+    cmake -DDEFINED_PROJECT_NAME="${PROJECT_NAME}" -DTEST_ONLY=OFF -DOCRA_BENCH=ON -DCMAKE_C_COMPILER=gcc -DCMAKE_CXX_COMPILER=g++ ..
+    make
+    ./bench/${PROJECT_NAME}-bench --benchmark_out="${PROJECT_NAME}-bench.json" --benchmark_out_format=json
+    echo "[ BENCH ] Results written to 'build/${PROJECT_NAME}-bench.json'"
+}
+
 testrun() {
     echo "[ BUILD ] Build project for tests"
     if [[ ! -d "./build" ]]; then
@@ -118,6 +131,7 @@ SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
 CLEAN_UP=false
 TEST_RUN=false
 NO_REBUILD=false
+BENCH_RUN=false
 TEST_GDB=false
 INSTALLP=false
 ADDITIONAL_FLAGS=0
@@ -126,7 +140,7 @@ CMAKE_FLAGS=''
 
 echo "[ BUILD ] Run script found at '$SCRIPT_DIR'"
 
-while getopts ":hctdkig:f:" option; do
+while getopts ":hctdkbig:f:" option; do
    case $option in
       h) help
          exit;;
@@ -140,6 +154,8 @@ while getopts ":hctdkig:f:" option; do
       k) echo "[ BUILD ] Test no rebuild ON"
          TEST_RUN=true
          NO_REBUILD=true;;
+      b) echo "[ BUILD ] Set benchmarks ON"
+         BENCH_RUN=true;;
       g) echo "[ BUILD ] GTest options ON"
          shift 1
          TEST_RUN=true
@@ -170,7 +186,9 @@ if [ $CLEAN_UP = true ]; then
     clean
 fi
 
-if [ $TEST_RUN = true ]; then
+if [ $BENCH_RUN = true ]; then
+    benchrun
+elif [ $TEST_RUN = true ]; then
     if [ $NO_REBUILD = true ]; then
         testrun_no_rebuild $TEST_GDB $ADDITIONAL_FLAGS $GTEST_FLAGS $CMAKE_FLAGS
     else 
@@ -0,0 +1,29 @@
+#include "ocra/ocra.hpp"
+#include "hash/hash.hpp"
+
+
+// Optional backend, defines the user functions with the built-in hash engine
+namespace ocra::user_implemented
+{
+std::vector<uint8_t> ShaHashing(const std::vector<uint8_t>& data,
+                                OcraSha shaType)
+{
+    if (shaType == OcraSha::None)
+        return {};
+
+    const auto algorithm = static_cast<hash::Algorithm>(shaType);
+    auto result = std::vector<uint8_t>(hash::DigestSize(algorithm));
+    hash::Digest(algorithm, data.data(), data.size(), result.data());
+    return result;
+}
+
+std::vector<uint8_t> HMACAlgorithm(const std::vector<uint8_t>& data,
+                                   const std::vector<uint8_t>& key,
+                                   OcraHmac hmacType)
+{
+    const auto algorithm = static_cast<hash::Algorithm>(hmacType);
+    auto result = std::vector<uint8_t>(hash::DigestSize(algorithm));
+    hash::Hmac(algorithm, key.data(), key.size(), data.data(), data.size(), result.data());
+    return result;
+}
+}  // namespace ocra::user_implemented
@@ -0,0 +1,506 @@
+#include "hash.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#include "kernels.hpp"
+
+
+namespace ocra::hash
+{
+namespace
+{
+constexpr uint32_t SHA1_IV[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+constexpr uint32_t SHA256_IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+constexpr uint64_t SHA512_IV[8] = {0x6a09e667f3bcc908, 0xbb67ae8584caa73b,
+                                   0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+                                   0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+                                   0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+
+
+struct Dispatch
+{
+    std::atomic<kernels::Sha32Compress> sha1{kernels::Sha1Portable};
+    std::atomic<kernels::Sha32Compress> sha256{kernels::Sha256Portable};
+    std::atomic<kernels::Sha64Compress> sha512{kernels::Sha512Portable};
+    std::atomic<Kernel> sha1Kernel{Kernel::Portable};
+    std::atomic<Kernel> sha256Kernel{Kernel::Portable};
+    std::atomic<Kernel> sha512Kernel{Kernel::Portable};
+    std::atomic<Kernel> lanesKernel{Kernel::Portable};
+};
+
+// Constant-initialized with the portable kernels, so hashing done by other
+// static initializers is still correct before the CPU has been checked
+Dispatch g_dispatch;
+
+
+const bool g_isKernelSelected = UseKernel(DetectKernel());
+
+
+inline void StoreBE32(uint8_t* output, uint32_t value)
+{
+    value = __builtin_bswap32(value);
+    memcpy(output, &value, sizeof(value));
+}
+
+inline void StoreBE64(uint8_t* output, uint64_t value)
+{
+    value = __builtin_bswap64(value);
+    memcpy(output, &value, sizeof(value));
+}
+}  // namespace
+
+
+bool IsSupported(Kernel kernel)
+{
+    if (kernel == Kernel::Portable)
+        return true;
+
+    #if defined(__x86_64__) || defined(__i386__)
+    const auto& cpu = kernels::Cpu();
+    if (kernel == Kernel::Avx2)
+        return cpu.avx2 && cpu.bmi2;
+    else if (kernel == Kernel::ShaNi)
+        return cpu.sha && cpu.ssse3 && cpu.sse41;
+    else if (kernel == Kernel::Avx512)
+        return cpu.avx512 && cpu.avx2 && cpu.bmi2;
+    #endif
+
+    return false;
+}
+
+Kernel DetectKernel()
+{
+    if (IsSupported(Kernel::Avx512))
+        return Kernel::Avx512;
+    else if (IsSupported(Kernel::ShaNi))
+        return Kernel::ShaNi;
+    else if (IsSupported(Kernel::Avx2))
+        return Kernel::Avx2;
+    return Kernel::Portable;
+}
+
+bool UseKernel(Kernel kernel)
+{
+    if (!IsSupported(kernel))
+        return false;
+
+    auto sha1 = kernels::Sha32Compress{kernels::Sha1Portable};
+    auto sha256 = kernels::Sha32Compress{kernels::Sha256Portable};
+    auto sha512 = kernels::Sha64Compress{kernels::Sha512Portable};
+    auto sha1Kernel = Kernel::Portable;
+    auto sha256Kernel = Kernel::Portable;
+    auto sha512Kernel = Kernel::Portable;
+
+    #if defined(__x86_64__) || defined(__i386__)
+    if (kernel >= Kernel::Avx2 && IsSupported(Kernel::Avx2))
+    {
+        sha1 = kernels::Sha1Avx2;
+        sha256 = kernels::Sha256Avx2;
+        sha512 = kernels::Sha512Avx2;
+        sha1Kernel = sha256Kernel = sha512Kernel = Kernel::Avx2;
+    }
+
+    // There are no SHA-512 instructions in SHA-NI, SHA-512 stays on the best vector kernel
+    if (kernel >= Kernel::ShaNi && IsSupported(Kernel::ShaNi))
+    {
+        sha1 = kernels::Sha1ShaNi;
+        sha256 = kernels::Sha256ShaNi;
+        sha1Kernel = sha256Kernel = Kernel::ShaNi;
+    }
+    #endif
+
+    g_dispatch.sha1.store(sha1, std::memory_order_relaxed);
+    g_dispatch.sha256.store(sha256, std::memory_order_relaxed);
+    g_dispatch.sha512.store(sha512, std::memory_order_relaxed);
+    g_dispatch.sha1Kernel.store(sha1Kernel, std::memory_order_relaxed);
+    g_dispatch.sha256Kernel.store(sha256Kernel, std::memory_order_relaxed);
+    g_dispatch.sha512Kernel.store(sha512Kernel, std::memory_order_relaxed);
+    g_dispatch.lanesKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+Kernel ActiveKernel(Algorithm algorithm)
+{
+    if (algorithm == Algorithm::SHA1)
+        return g_dispatch.sha1Kernel.load(std::memory_order_relaxed);
+    else if (algorithm == Algorithm::SHA256)
+        return g_dispatch.sha256Kernel.load(std::memory_order_relaxed);
+    return g_dispatch.sha512Kernel.load(std::memory_order_relaxed);
+}
+
+std::size_t Lanes(Algorithm algorithm)
+{
+    const auto words = algorithm == Algorithm::SHA512 ? 2u : 1u;
+    #if defined(__x86_64__) || defined(__i386__)
+    const auto kernel = g_dispatch.lanesKernel.load(std::memory_order_relaxed);
+    if (kernel == Kernel::Avx512)
+        return 16u / words;
+    else if (kernel != Kernel::Portable)
+        return 8u / words;
+    return 4u / words;
+    #else
+    // The generic vectors would be split into scalar code, no gain over single messages
+    (void)(words);
+    return 1u;
+    #endif
+}
+
+
+void Context::Init(Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+    m_length = 0u;
+    m_buffered = 0u;
+
+    if (algorithm == Algorithm::SHA1)
+        memcpy(m_state.h32, SHA1_IV, sizeof(SHA1_IV));
+    else if (algorithm == Algorithm::SHA256)
+        memcpy(m_state.h32, SHA256_IV, sizeof(SHA256_IV));
+    else
+        memcpy(m_state.h64, SHA512_IV, sizeof(SHA512_IV));
+}
+
+void Context::Compress(const uint8_t* blocks, std::size_t count)
+{
+    if (m_algorithm == Algorithm::SHA1)
+        g_dispatch.sha1.load(std::memory_order_relaxed)(m_state.h32, blocks, count);
+    else if (m_algorithm == Algorithm::SHA256)
+        g_dispatch.sha256.load(std::memory_order_relaxed)(m_state.h32, blocks, count);
+    else
+        g_dispatch.sha512.load(std::memory_order_relaxed)(m_state.h64, blocks, count);
+}
+
+void Context::Update(const uint8_t* data, std::size_t size)
+{
+    const auto BLOCK_SIZE = BlockSize(m_algorithm);
+    m_length += size;
+
+    if (m_buffered)
+    {
+        const auto missing = BLOCK_SIZE - m_buffered;
+        if (size < missing)
+        {
+            memcpy(m_buffer + m_buffered, data, size);
+            m_buffered += size;
+            return;
+        }
+
+        memcpy(m_buffer + m_buffered, data, missing);
+        Compress(m_buffer, 1u);
+        data += missing;
+        size -= missing;
+        m_buffered = 0u;
+    }
+
+    const auto blocks = size / BLOCK_SIZE;
+    if (blocks)
+    {
+        Compress(data, blocks);
+        data += blocks * BLOCK_SIZE;
+        size -= blocks * BLOCK_SIZE;
+    }
+
+    if (size)
+    {
+        memcpy(m_buffer, data, size);
+        m_buffered = size;
+    }
+}
+
+void Context::Final(uint8_t* digest)
+{
+    const auto BLOCK_SIZE = BlockSize(m_algorithm);
+    const auto LENGTH_FIELD_SIZE = m_algorithm == Algorithm::SHA512 ? 16u : 8u;
+    const auto bits = m_length * 8u;
+
+    m_buffer[m_buffered++] = 0x80;
+    if (m_buffered > BLOCK_SIZE - LENGTH_FIELD_SIZE)
+    {
+        memset(m_buffer + m_buffered, 0, BLOCK_SIZE - m_buffered);
+        Compress(m_buffer, 1u);
+        m_buffered = 0u;
+    }
+
+    memset(m_buffer + m_buffered, 0, BLOCK_SIZE - m_buffered);
+    StoreBE64(m_buffer + BLOCK_SIZE - 8u, bits);
+    Compress(m_buffer, 1u);
+
+    if (m_algorithm == Algorithm::SHA512)
+    {
+        for (auto i = 0u; i < 8u; ++i)
+            StoreBE64(digest + 8 * i, m_state.h64[i]);
+    }
+    else
+    {
+        const auto words = DigestSize(m_algorithm) / 4u;
+        for (auto i = 0u; i < words; ++i)
+            StoreBE32(digest + 4 * i, m_state.h32[i]);
+    }
+}
+
+
+void HmacContext::Init(Algorithm algorithm, const uint8_t* key, std::size_t keySize)
+{
+    constexpr uint8_t INNER_PAD = 0x36;
+    constexpr uint8_t OUTER_PAD = 0x5c;
+    const auto BLOCK_SIZE = BlockSize(algorithm);
+
+    uint8_t block[MAX_BLOCK_SIZE] = {};
+    if (keySize > BLOCK_SIZE)
+        Digest(algorithm, key, keySize, block);
+    else if (keySize)
+        memcpy(block, key, keySize);
+
+    for (auto i = 0u; i < BLOCK_SIZE; ++i)
+        block[i] ^= INNER_PAD;
+    m_inner.Init(algorithm);
+    m_inner.Update(block, BLOCK_SIZE);
+
+    for (auto i = 0u; i < BLOCK_SIZE; ++i)
+        block[i] ^= INNER_PAD ^ OUTER_PAD;
+    m_outer.Init(algorithm);
+    m_outer.Update(block, BLOCK_SIZE);
+}
+
+void HmacContext::Final(uint8_t* digest)
+{
+    uint8_t innerDigest[MAX_DIGEST_SIZE];
+    m_inner.Final(innerDigest);
+    m_outer.Update(innerDigest, DigestSize(GetAlgorithm()));
+    m_outer.Final(digest);
+}
+
+
+namespace
+{
+void CompressLanes(Algorithm algorithm, std::size_t lanes, void* state,
+                   const uint8_t* const* blocks, std::size_t count)
+{
+    auto* state32 = static_cast<uint32_t*>(state);
+    auto* state64 = static_cast<uint64_t*>(state);
+    if (algorithm == Algorithm::SHA1)
+    {
+        #if defined(__x86_64__) || defined(__i386__)
+        if (lanes == 16u)
+            return kernels::Sha1Lanes16(state32, blocks, count);
+        else if (lanes == 8u)
+            return kernels::Sha1Lanes8(state32, blocks, count);
+        #endif
+        return kernels::Sha1Lanes4(state32, blocks, count);
+    }
+    else if (algorithm == Algorithm::SHA256)
+    {
+        #if defined(__x86_64__) || defined(__i386__)
+        if (lanes == 16u)
+            return kernels::Sha256Lanes16(state32, blocks, count);
+        else if (lanes == 8u)
+            return kernels::Sha256Lanes8(state32, blocks, count);
+        #endif
+        return kernels::Sha256Lanes4(state32, blocks, count);
+    }
+
+    #if defined(__x86_64__) || defined(__i386__)
+    if (lanes == 8u)
+        return kernels::Sha512Lanes8(state64, blocks, count);
+    else if (lanes == 4u)
+        return kernels::Sha512Lanes4(state64, blocks, count);
+    #endif
+    kernels::Sha512Lanes2(state64, blocks, count);
+}
+
+void InitLanes(Algorithm algorithm, std::size_t lanes, void* state)
+{
+    auto* state32 = static_cast<uint32_t*>(state);
+    auto* state64 = static_cast<uint64_t*>(state);
+    for (auto i = 0u; i < 8u; ++i)
+    {
+        for (auto l = 0u; l < lanes; ++l)
+        {
+            if (algorithm == Algorithm::SHA1)
+                state32[i * lanes + l] = i < 5u ? SHA1_IV[i] : 0u;
+            else if (algorithm == Algorithm::SHA256)
+                state32[i * lanes + l] = SHA256_IV[i];
+            else
+                state64[i * lanes + l] = SHA512_IV[i];
+        }
+    }
+}
+
+void StoreLanesDigest(Algorithm algorithm, std::size_t lanes, const void* state,
+                      std::size_t lane, uint8_t* digest)
+{
+    if (algorithm == Algorithm::SHA512)
+    {
+        for (auto i = 0u; i < 8u; ++i)
+            StoreBE64(digest + 8 * i, static_cast<const uint64_t*>(state)[i * lanes + lane]);
+        return;
+    }
+
+    const auto words = DigestSize(algorithm) / 4u;
+    for (auto i = 0u; i < words; ++i)
+        StoreBE32(digest + 4 * i, static_cast<const uint32_t*>(state)[i * lanes + lane]);
+}
+
+// Writes the message tail with the SHA padding, returns the number of blocks
+std::size_t PadLanesTail(Algorithm algorithm, uint8_t* output, const uint8_t* tail,
+                         std::size_t size, uint64_t totalSize)
+{
+    const auto BLOCK_SIZE = BlockSize(algorithm);
+    const auto LENGTH_FIELD_SIZE = algorithm == Algorithm::SHA512 ? 16u : 8u;
+    const auto blocks = size + 1u + LENGTH_FIELD_SIZE > BLOCK_SIZE ? 2u : 1u;
+
+    memcpy(output, tail, size);
+    output[size] = 0x80;
+    memset(output + size + 1u, 0, blocks * BLOCK_SIZE - size - 1u);
+    StoreBE64(output + blocks * BLOCK_SIZE - 8u, totalSize * 8u);
+    return blocks;
+}
+
+// Copies the state of the single-message context into every lane
+void BroadcastLanes(Algorithm algorithm, std::size_t lanes, void* state, const void* single)
+{
+    const auto wordSize = algorithm == Algorithm::SHA512 ? 8u : 4u;
+    for (auto i = 0u; i < 8u; ++i)
+        for (auto l = 0u; l < lanes; ++l)
+            memcpy(static_cast<uint8_t*>(state) + (i * lanes + l) * wordSize,
+                   static_cast<const uint8_t*>(single) + i * wordSize, wordSize);
+}
+
+// The lanes start either from the midstates of 'key' or from their own raw 'keys'
+void HmacGroup(Algorithm algorithm, std::size_t lanes, std::size_t count,
+               const void* innerState, const void* outerState,
+               const uint8_t* const* keys, const std::size_t* keySizes,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests)
+{
+    constexpr uint8_t INNER_PAD = 0x36;
+    constexpr uint8_t OUTER_PAD = 0x5c;
+    const auto BLOCK_SIZE = BlockSize(algorithm);
+    const auto DIGEST_SIZE = DigestSize(algorithm);
+
+    alignas(64) uint8_t pads[MAX_LANES][MAX_BLOCK_SIZE] = {};
+    alignas(64) uint8_t tails[MAX_LANES][2 * MAX_BLOCK_SIZE];
+    alignas(64) uint64_t state[8 * MAX_LANES];
+    const uint8_t* padBlocks[MAX_LANES];
+    const uint8_t* messageBlocks[MAX_LANES];
+    const uint8_t* tailBlocks[MAX_LANES];
+
+    // Lanes without a message repeat the first one, their results are dropped
+    const auto full = size / BLOCK_SIZE;
+    const auto rest = size - full * BLOCK_SIZE;
+    auto blocks = std::size_t{};
+    for (auto l = 0u; l < lanes; ++l)
+    {
+        const auto lane = l < count ? l : 0u;
+        if (!innerState)
+        {
+            if (keySizes[lane] > BLOCK_SIZE)
+                Digest(algorithm, keys[lane], keySizes[lane], pads[l]);
+            else if (keySizes[lane])
+                memcpy(pads[l], keys[lane], keySizes[lane]);
+
+            for (auto i = 0u; i < BLOCK_SIZE; ++i)
+                pads[l][i] ^= INNER_PAD;
+        }
+
+        blocks = PadLanesTail(algorithm, tails[l], messages[lane] + full * BLOCK_SIZE, rest, BLOCK_SIZE + size);
+        padBlocks[l] = pads[l];
+        messageBlocks[l] = messages[lane];
+        tailBlocks[l] = tails[l];
+    }
+
+    if (innerState)
+        BroadcastLanes(algorithm, lanes, state, innerState);
+    else
+    {
+        InitLanes(algorithm, lanes, state);
+        CompressLanes(algorithm, lanes, state, padBlocks, 1u);
+    }
+
+    if (full)
+        CompressLanes(algorithm, lanes, state, messageBlocks, full);
+    CompressLanes(algorithm, lanes, state, tailBlocks, blocks);
+
+    for (auto l = 0u; l < lanes; ++l)
+    {
+        uint8_t innerDigest[MAX_DIGEST_SIZE];
+        StoreLanesDigest(algorithm, lanes, state, l, innerDigest);
+        PadLanesTail(algorithm, tails[l], innerDigest, DIGEST_SIZE, BLOCK_SIZE + DIGEST_SIZE);
+
+        if (!innerState)
+        {
+            for (auto i = 0u; i < BLOCK_SIZE; ++i)
+                pads[l][i] ^= INNER_PAD ^ OUTER_PAD;
+        }
+    }
+
+    if (outerState)
+        BroadcastLanes(algorithm, lanes, state, outerState);
+    else
+    {
+        InitLanes(algorithm, lanes, state);
+        CompressLanes(algorithm, lanes, state, padBlocks, 1u);
+    }
+    CompressLanes(algorithm, lanes, state, tailBlocks, 1u);
+
+    for (auto l = 0u; l < count; ++l)
+        StoreLanesDigest(algorithm, lanes, state, l, digests[l]);
+}
+}  // namespace
+
+
+void Digest(Algorithm algorithm, const uint8_t* data, std::size_t size, uint8_t* digest)
+{
+    auto context = Context(algorithm);
+    context.Update(data, size);
+    context.Final(digest);
+}
+
+void Hmac(Algorithm algorithm, const uint8_t* key, std::size_t keySize,
+          const uint8_t* data, std::size_t size, uint8_t* digest)
+{
+    auto context = HmacContext(algorithm, key, keySize);
+    context.Update(data, size);
+    context.Final(digest);
+}
+
+void HmacLanes(Algorithm algorithm, std::size_t count,
+               const uint8_t* const* keys, const std::size_t* keySizes,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests)
+{
+    const auto lanes = Lanes(algorithm);
+    for (auto first = std::size_t{}; first < count; first += lanes)
+    {
+        const auto group = count - first < lanes ? count - first : lanes;
+        if (group == 1u)
+            Hmac(algorithm, keys[first], keySizes[first], messages[first], size, digests[first]);
+        else
+            HmacGroup(algorithm, lanes, group, nullptr, nullptr, keys + first, keySizes + first,
+                      messages + first, size, digests + first);
+    }
+}
+
+void HmacLanes(const HmacContext& key, std::size_t count,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests)
+{
+    const auto algorithm = key.GetAlgorithm();
+    const auto lanes = Lanes(algorithm);
+    for (auto first = std::size_t{}; first < count; first += lanes)
+    {
+        const auto group = count - first < lanes ? count - first : lanes;
+        if (group == 1u)
+        {
+            auto context = key;
+            context.Update(messages[first], size);
+            context.Final(digests[first]);
+        }
+        else
+            HmacGroup(algorithm, lanes, group, &key.m_inner.m_state, &key.m_outer.m_state,
+                      nullptr, nullptr, messages + first, size, digests + first);
+    }
+}
+
+}  // namespace ocra::hash
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+
+
+namespace ocra::hash
+{
+// Values match 'OcraSha' and 'OcraHmac' so the types can be converted with static_cast
+enum class Algorithm
+{
+    SHA1 = 1,
+    SHA256 = 256,
+    SHA512 = 512
+};
+
+
+// Compression kernels, ordered from the most portable to the most specialized one
+enum class Kernel
+{
+    Portable = 0,
+    Avx2 = 1,
+    ShaNi = 2,
+    Avx512 = 3  // multi-buffer only, single messages use the best of ShaNi and Avx2
+};
+
+
+constexpr std::size_t MAX_BLOCK_SIZE = 128u;
+constexpr std::size_t MAX_DIGEST_SIZE = 64u;
+constexpr std::size_t MAX_LANES = 16u;
+
+constexpr std::size_t BlockSize(Algorithm algorithm)
+{
+    return algorithm == Algorithm::SHA512 ? 128u : 64u;
+}
+
+constexpr std::size_t DigestSize(Algorithm algorithm)
+{
+    return algorithm == Algorithm::SHA1 ? 20u :
+        (algorithm == Algorithm::SHA256 ? 32u : 64u);
+}
+
+
+bool IsSupported(Kernel kernel);
+Kernel DetectKernel();
+bool UseKernel(Kernel kernel);
+Kernel ActiveKernel(Algorithm algorithm);
+std::size_t Lanes(Algorithm algorithm);
+
+
+class HmacContext;
+
+void HmacLanes(const HmacContext& key, std::size_t count,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests);
+
+
+class Context
+{
+public:
+    Context() = default;
+    explicit Context(Algorithm algorithm) { Init(algorithm); }
+
+    inline Algorithm GetAlgorithm() const { return m_algorithm; }
+
+    void Init(Algorithm algorithm);
+    void Update(const uint8_t* data, std::size_t size);
+    void Final(uint8_t* digest);
+
+private:
+    friend void HmacLanes(const HmacContext& key, std::size_t count,
+                          const uint8_t* const* messages, std::size_t size, uint8_t* const* digests);
+
+    void Compress(const uint8_t* blocks, std::size_t count);
+
+private:
+    union
+    {
+        uint32_t h32[8];
+        uint64_t h64[8];
+    } m_state = {};
+    alignas(16) uint8_t m_buffer[MAX_BLOCK_SIZE] = {};
+    uint64_t m_length = {};
+    uint32_t m_buffered = {};
+    Algorithm m_algorithm = Algorithm::SHA1;
+};
+
+
+class HmacContext
+{
+public:
+    HmacContext() = default;
+    HmacContext(Algorithm algorithm, const uint8_t* key, std::size_t keySize)
+    {
+        Init(algorithm, key, keySize);
+    }
+
+    inline Algorithm GetAlgorithm() const { return m_inner.GetAlgorithm(); }
+
+    void Init(Algorithm algorithm, const uint8_t* key, std::size_t keySize);
+    void Update(const uint8_t* data, std::size_t size) { m_inner.Update(data, size); }
+    void Final(uint8_t* digest);
+
+private:
+    friend void HmacLanes(const HmacContext& key, std::size_t count,
+                          const uint8_t* const* messages, std::size_t size, uint8_t* const* digests);
+
+    Context m_inner;
+    Context m_outer;
+};
+
+
+void Digest(Algorithm algorithm, const uint8_t* data, std::size_t size, uint8_t* digest);
+void Hmac(Algorithm algorithm, const uint8_t* key, std::size_t keySize,
+          const uint8_t* data, std::size_t size, uint8_t* digest);
+
+// Multi-buffer HMAC of 'count' independent messages of the same size, hashed
+// 'Lanes(algorithm)' at a time side by side in the vector registers
+void HmacLanes(Algorithm algorithm, std::size_t count,
+               const uint8_t* const* keys, const std::size_t* keySizes,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests);
+
+// The same for messages under one key, 'key' must be freshly initialized (no Update yet)
+void HmacLanes(const HmacContext& key, std::size_t count,
+               const uint8_t* const* messages, std::size_t size, uint8_t* const* digests);
+
+}  // namespace ocra::hash
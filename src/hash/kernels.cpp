@@ -0,0 +1,655 @@
+#include "kernels.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define OCRA_HASH_X86
+#endif
+
+#define OCRA_HASH_INLINE inline __attribute__((always_inline))
+
+// Lane vectors of the multi-buffer kernels, the widths above 16 bytes are used
+// only inside functions compiled for the matching instruction set
+typedef uint32_t Vector32x4 __attribute__((vector_size(16)));
+typedef uint32_t Vector32x8 __attribute__((vector_size(32)));
+typedef uint32_t Vector32x16 __attribute__((vector_size(64)));
+typedef uint64_t Vector64x2 __attribute__((vector_size(16)));
+typedef uint64_t Vector64x4 __attribute__((vector_size(32)));
+typedef uint64_t Vector64x8 __attribute__((vector_size(64)));
+
+
+namespace ocra::hash::kernels
+{
+namespace
+{
+constexpr uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr uint64_t K512[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+    0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+    0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
+    0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+    0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+    0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
+    0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+    0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
+    0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+    0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+    0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+    0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+    0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+    0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+
+OCRA_HASH_INLINE uint32_t Rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+OCRA_HASH_INLINE uint32_t Rotr32(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+OCRA_HASH_INLINE uint64_t Rotr64(uint64_t x, int n) { return (x >> n) | (x << (64 - n)); }
+
+OCRA_HASH_INLINE uint32_t LoadBE32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return __builtin_bswap32(value);
+}
+
+OCRA_HASH_INLINE uint64_t LoadBE64(const uint8_t* data)
+{
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return __builtin_bswap64(value);
+}
+
+
+// The generic compression bodies are force-inlined into every kernel,
+// so each target-specific wrapper gets its own instruction selection
+OCRA_HASH_INLINE void Sha1Blocks(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    for (; count; --count, blocks += 64)
+    {
+        uint32_t w[16];
+        for (auto i = 0u; i < 16; ++i)
+            w[i] = LoadBE32(blocks + 4 * i);
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (auto t = 0u; t < 80; ++t)
+        {
+            if (t >= 16)
+                w[t & 15] = Rotl32(w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15], 1);
+
+            uint32_t f, k;
+            if (t < 20)
+            {
+                f = d ^ (b & (c ^ d));
+                k = 0x5a827999;
+            }
+            else if (t < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if (t < 60)
+            {
+                f = (b & c) | (d & (b | c));
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+
+            const auto temp = Rotl32(a, 5) + f + e + k + w[t & 15];
+            e = d;
+            d = c;
+            c = Rotl32(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+OCRA_HASH_INLINE void Sha256Blocks(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    for (; count; --count, blocks += 64)
+    {
+        uint32_t w[64];
+        for (auto i = 0u; i < 16; ++i)
+            w[i] = LoadBE32(blocks + 4 * i);
+        for (auto i = 16u; i < 64; ++i)
+        {
+            const auto s0 = Rotr32(w[i - 15], 7) ^ Rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const auto s1 = Rotr32(w[i - 2], 17) ^ Rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (auto t = 0u; t < 64; ++t)
+        {
+            const auto s1 = Rotr32(e, 6) ^ Rotr32(e, 11) ^ Rotr32(e, 25);
+            const auto ch = g ^ (e & (f ^ g));
+            const auto temp1 = h + s1 + ch + K256[t] + w[t];
+            const auto s0 = Rotr32(a, 2) ^ Rotr32(a, 13) ^ Rotr32(a, 22);
+            const auto maj = (a & b) | (c & (a | b));
+            const auto temp2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+OCRA_HASH_INLINE void Sha512Blocks(uint64_t* state, const uint8_t* blocks, std::size_t count)
+{
+    for (; count; --count, blocks += 128)
+    {
+        uint64_t w[80];
+        for (auto i = 0u; i < 16; ++i)
+            w[i] = LoadBE64(blocks + 8 * i);
+        for (auto i = 16u; i < 80; ++i)
+        {
+            const auto s0 = Rotr64(w[i - 15], 1) ^ Rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            const auto s1 = Rotr64(w[i - 2], 19) ^ Rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (auto t = 0u; t < 80; ++t)
+        {
+            const auto s1 = Rotr64(e, 14) ^ Rotr64(e, 18) ^ Rotr64(e, 41);
+            const auto ch = g ^ (e & (f ^ g));
+            const auto temp1 = h + s1 + ch + K512[t] + w[t];
+            const auto s0 = Rotr64(a, 28) ^ Rotr64(a, 34) ^ Rotr64(a, 39);
+            const auto maj = (a & b) | (c & (a | b));
+            const auto temp2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+
+// Multi-buffer bodies, every lane of the vector 'V' hashes its own message.
+// The state is lane-interleaved: word 'i' of lane 'l' is 'state[i * LANES + l]'
+template <typename V>
+constexpr std::size_t LANES_OF = sizeof(V) / sizeof(V{}[0]);
+
+template <typename V>
+OCRA_HASH_INLINE void Sha1Lanes(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    constexpr auto LANES = LANES_OF<V>;
+    for (auto offset = std::size_t{}; count; --count, offset += 64)
+    {
+        alignas(64) uint32_t words[16][LANES];
+        for (auto i = 0u; i < 16; ++i)
+            for (auto l = 0u; l < LANES; ++l)
+                words[i][l] = LoadBE32(blocks[l] + offset + 4 * i);
+
+        // Vectors are only copied with memcpy, the helpers taking them by value
+        // would change the calling convention of the portable build
+        V w[16];
+        memcpy(w, words, sizeof(w));
+
+        V h[5];
+        memcpy(h, state, sizeof(h));
+
+        auto a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (auto t = 0u; t < 80; ++t)
+        {
+            if (t >= 16)
+            {
+                const V x = w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15];
+                w[t & 15] = (x << 1) | (x >> 31);
+            }
+
+            V f;
+            uint32_t k;
+            if (t < 20)
+            {
+                f = d ^ (b & (c ^ d));
+                k = 0x5a827999;
+            }
+            else if (t < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if (t < 60)
+            {
+                f = (b & c) | (d & (b | c));
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+
+            const V temp = ((a << 5) | (a >> 27)) + f + e + k + w[t & 15];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        memcpy(state, h, sizeof(h));
+    }
+}
+
+template <typename V>
+OCRA_HASH_INLINE void Sha256Lanes(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    constexpr auto LANES = LANES_OF<V>;
+    for (auto offset = std::size_t{}; count; --count, offset += 64)
+    {
+        alignas(64) uint32_t words[16][LANES];
+        for (auto i = 0u; i < 16; ++i)
+            for (auto l = 0u; l < LANES; ++l)
+                words[i][l] = LoadBE32(blocks[l] + offset + 4 * i);
+
+        V w[16];
+        memcpy(w, words, sizeof(w));
+
+        V h[8];
+        memcpy(h, state, sizeof(h));
+
+        auto a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (auto t = 0u; t < 64; ++t)
+        {
+            if (t >= 16)
+            {
+                const V w15 = w[(t + 1) & 15];
+                const V w2 = w[(t + 14) & 15];
+                const V s0 = ((w15 >> 7) | (w15 << 25)) ^ ((w15 >> 18) | (w15 << 14)) ^ (w15 >> 3);
+                const V s1 = ((w2 >> 17) | (w2 << 15)) ^ ((w2 >> 19) | (w2 << 13)) ^ (w2 >> 10);
+                w[t & 15] += s0 + w[(t + 9) & 15] + s1;
+            }
+
+            const V s1 = ((e >> 6) | (e << 26)) ^ ((e >> 11) | (e << 21)) ^ ((e >> 25) | (e << 7));
+            const V ch = g ^ (e & (f ^ g));
+            const V temp1 = hh + s1 + ch + K256[t] + w[t & 15];
+            const V s0 = ((a >> 2) | (a << 30)) ^ ((a >> 13) | (a << 19)) ^ ((a >> 22) | (a << 10));
+            const V maj = (a & b) | (c & (a | b));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + s0 + maj;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+        memcpy(state, h, sizeof(h));
+    }
+}
+
+template <typename V>
+OCRA_HASH_INLINE void Sha512Lanes(uint64_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    constexpr auto LANES = LANES_OF<V>;
+    for (auto offset = std::size_t{}; count; --count, offset += 128)
+    {
+        alignas(64) uint64_t words[16][LANES];
+        for (auto i = 0u; i < 16; ++i)
+            for (auto l = 0u; l < LANES; ++l)
+                words[i][l] = LoadBE64(blocks[l] + offset + 8 * i);
+
+        V w[16];
+        memcpy(w, words, sizeof(w));
+
+        V h[8];
+        memcpy(h, state, sizeof(h));
+
+        auto a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (auto t = 0u; t < 80; ++t)
+        {
+            if (t >= 16)
+            {
+                const V w15 = w[(t + 1) & 15];
+                const V w2 = w[(t + 14) & 15];
+                const V s0 = ((w15 >> 1) | (w15 << 63)) ^ ((w15 >> 8) | (w15 << 56)) ^ (w15 >> 7);
+                const V s1 = ((w2 >> 19) | (w2 << 45)) ^ ((w2 >> 61) | (w2 << 3)) ^ (w2 >> 6);
+                w[t & 15] += s0 + w[(t + 9) & 15] + s1;
+            }
+
+            const V s1 = ((e >> 14) | (e << 50)) ^ ((e >> 18) | (e << 46)) ^ ((e >> 41) | (e << 23));
+            const V ch = g ^ (e & (f ^ g));
+            const V temp1 = hh + s1 + ch + K512[t] + w[t & 15];
+            const V s0 = ((a >> 28) | (a << 36)) ^ ((a >> 34) | (a << 30)) ^ ((a >> 39) | (a << 25));
+            const V maj = (a & b) | (c & (a | b));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + s0 + maj;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+        memcpy(state, h, sizeof(h));
+    }
+}
+
+#ifdef OCRA_HASH_X86
+CpuFeatures DetectCpu()
+{
+    auto features = CpuFeatures{};
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return features;
+
+    features.ssse3 = ecx & bit_SSSE3;
+    features.sse41 = ecx & bit_SSE4_1;
+
+    auto xcr0 = uint64_t{};
+    if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX))
+    {
+        uint32_t xcr0Low = 0, xcr0High = 0;
+        __asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        xcr0 = (uint64_t{xcr0High} << 32) | xcr0Low;
+    }
+    const auto isAvxEnabled = (xcr0 & 0x06) == 0x06;
+    const auto isAvx512Enabled = (xcr0 & 0xe6) == 0xe6;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return features;
+
+    features.avx2 = isAvxEnabled && (ebx & bit_AVX2);
+    features.bmi2 = ebx & bit_BMI2;
+    features.sha = ebx & bit_SHA;
+    features.avx512 = isAvx512Enabled && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW);
+    return features;
+}
+#else
+CpuFeatures DetectCpu()
+{
+    return CpuFeatures{};
+}
+#endif
+}  // namespace
+
+
+const CpuFeatures& Cpu()
+{
+    static const auto features = DetectCpu();
+    return features;
+}
+
+void Sha1Portable(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha1Blocks(state, blocks, count);
+}
+
+void Sha256Portable(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha256Blocks(state, blocks, count);
+}
+
+void Sha512Portable(uint64_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha512Blocks(state, blocks, count);
+}
+
+void Sha1Lanes4(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha1Lanes<Vector32x4>(state, blocks, count);
+}
+
+void Sha256Lanes4(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha256Lanes<Vector32x4>(state, blocks, count);
+}
+
+void Sha512Lanes2(uint64_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha512Lanes<Vector64x2>(state, blocks, count);
+}
+
+#ifdef OCRA_HASH_X86
+// The AVX2 tier is the generic code compiled for AVX2/BMI2, rotations become
+// 'rorx' and the message schedule is free to use the wide registers
+__attribute__((target("avx2,bmi,bmi2")))
+void Sha1Avx2(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha1Blocks(state, blocks, count);
+}
+
+__attribute__((target("avx2,bmi,bmi2")))
+void Sha256Avx2(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha256Blocks(state, blocks, count);
+}
+
+__attribute__((target("avx2,bmi,bmi2")))
+void Sha512Avx2(uint64_t* state, const uint8_t* blocks, std::size_t count)
+{
+    Sha512Blocks(state, blocks, count);
+}
+
+__attribute__((target("sha,sse4.1")))
+void Sha1ShaNi(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    const auto MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    auto abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    auto e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    abcd = _mm_shuffle_epi32(abcd, 0x1b);
+
+    for (; count; --count, blocks += 64)
+    {
+        const auto abcdSave = abcd;
+        const auto e0Save = e0;
+
+        __m128i msg[4];
+        __m128i e = e0;
+        __m128i ePrevious = e0;
+
+        #pragma GCC unroll 20
+        for (auto j = 0u; j < 20; ++j)
+        {
+            auto& current = msg[j % 4];
+            if (j < 4)
+            {
+                current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * j));
+                current = _mm_shuffle_epi8(current, MASK);
+            }
+            else
+            {
+                current = _mm_sha1msg1_epu32(current, msg[(j - 3) % 4]);
+                current = _mm_xor_si128(current, msg[(j - 2) % 4]);
+                current = _mm_sha1msg2_epu32(current, msg[(j - 1) % 4]);
+            }
+
+            e = j == 0 ? _mm_add_epi32(e0, current) : _mm_sha1nexte_epu32(ePrevious, current);
+            ePrevious = abcd;
+
+            switch (j / 5)
+            {
+                case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+                case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+                case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+                default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+            }
+        }
+
+        e0 = _mm_sha1nexte_epu32(ePrevious, e0Save);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1b);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+__attribute__((target("sha,sse4.1")))
+void Sha256ShaNi(uint32_t* state, const uint8_t* blocks, std::size_t count)
+{
+    const auto MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    auto tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    auto state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);             // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1b);       // EFGH
+    auto state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);    // CDGH
+
+    for (; count; --count, blocks += 64)
+    {
+        const auto abefSave = state0;
+        const auto cdghSave = state1;
+
+        __m128i msg[4];
+
+        #pragma GCC unroll 16
+        for (auto j = 0u; j < 16; ++j)
+        {
+            auto& current = msg[j % 4];
+            if (j < 4)
+            {
+                current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * j));
+                current = _mm_shuffle_epi8(current, MASK);
+            }
+            else
+            {
+                const auto previous = msg[(j - 1) % 4];
+                current = _mm_sha256msg1_epu32(current, msg[(j - 3) % 4]);
+                current = _mm_add_epi32(current, _mm_alignr_epi8(previous, msg[(j - 2) % 4], 4));
+                current = _mm_sha256msg2_epu32(current, previous);
+            }
+
+            auto rounds = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K256 + 4 * j)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, rounds);
+            rounds = _mm_shuffle_epi32(rounds, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, rounds);
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+__attribute__((target("avx2")))
+void Sha1Lanes8(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha1Lanes<Vector32x8>(state, blocks, count);
+}
+
+__attribute__((target("avx2")))
+void Sha256Lanes8(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha256Lanes<Vector32x8>(state, blocks, count);
+}
+
+__attribute__((target("avx2")))
+void Sha512Lanes4(uint64_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha512Lanes<Vector64x4>(state, blocks, count);
+}
+
+// AVX-512 turns the rotations into single 'vprold'/'vprolq' instructions
+__attribute__((target("avx512f")))
+void Sha1Lanes16(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha1Lanes<Vector32x16>(state, blocks, count);
+}
+
+__attribute__((target("avx512f")))
+void Sha256Lanes16(uint32_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha256Lanes<Vector32x16>(state, blocks, count);
+}
+
+__attribute__((target("avx512f")))
+void Sha512Lanes8(uint64_t* state, const uint8_t* const* blocks, std::size_t count)
+{
+    Sha512Lanes<Vector64x8>(state, blocks, count);
+}
+#endif
+
+}  // namespace ocra::hash::kernels
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+
+
+// Internal header, the compression functions process 'count' full blocks
+namespace ocra::hash::kernels
+{
+using Sha32Compress = void (*)(uint32_t* state, const uint8_t* blocks, std::size_t count);
+using Sha64Compress = void (*)(uint64_t* state, const uint8_t* blocks, std::size_t count);
+
+// Multi-buffer compression, 'count' blocks of every lane message, the lane count
+// is the number in the function name and the state is lane-interleaved
+using Sha32CompressLanes = void (*)(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+using Sha64CompressLanes = void (*)(uint64_t* state, const uint8_t* const* blocks, std::size_t count);
+
+struct CpuFeatures
+{
+    bool ssse3 = {};
+    bool sse41 = {};
+    bool avx2 = {};
+    bool bmi2 = {};
+    bool sha = {};
+    bool avx512 = {};
+};
+
+const CpuFeatures& Cpu();
+
+void Sha1Portable(uint32_t* state, const uint8_t* blocks, std::size_t count);
+void Sha256Portable(uint32_t* state, const uint8_t* blocks, std::size_t count);
+void Sha512Portable(uint64_t* state, const uint8_t* blocks, std::size_t count);
+
+void Sha1Lanes4(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha256Lanes4(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha512Lanes2(uint64_t* state, const uint8_t* const* blocks, std::size_t count);
+
+#if defined(__x86_64__) || defined(__i386__)
+void Sha1Avx2(uint32_t* state, const uint8_t* blocks, std::size_t count);
+void Sha256Avx2(uint32_t* state, const uint8_t* blocks, std::size_t count);
+void Sha512Avx2(uint64_t* state, const uint8_t* blocks, std::size_t count);
+
+void Sha1ShaNi(uint32_t* state, const uint8_t* blocks, std::size_t count);
+void Sha256ShaNi(uint32_t* state, const uint8_t* blocks, std::size_t count);
+
+void Sha1Lanes8(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha256Lanes8(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha512Lanes4(uint64_t* state, const uint8_t* const* blocks, std::size_t count);
+
+void Sha1Lanes16(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha256Lanes16(uint32_t* state, const uint8_t* const* blocks, std::size_t count);
+void Sha512Lanes8(uint64_t* state, const uint8_t* const* blocks, std::size_t count);
+#endif
+
+}  // namespace ocra::hash::kernels
@@ -3,6 +3,7 @@
 #include <iostream>
 
 
+#ifndef OCRA_BUILTIN_HASH
 namespace ocra::user_implemented
 {
 std::vector<uint8_t> ShaHashing(const std::vector<uint8_t>& data,
@@ -12,6 +13,7 @@ std::vector<uint8_t> HMACAlgorithm(const std::vector<uint8_t>& data,
                                    const std::vector<uint8_t>& key,
                                    OcraHmac hmacType) { return {0x05, 0xAB, 0xAC, 0x01, 0x89, 0x94}; }
 } // namespace ocra::user_implemented
+#endif
 
 
 int main()
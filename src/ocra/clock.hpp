@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <inttypes.h>
+
+
+namespace ocra
+{
+// Source of the current time for the time-step verification, seconds since the Unix epoch
+class Clock
+{
+public:
+    virtual ~Clock() = default;
+    virtual uint64_t Now() const = 0;
+};
+
+
+class SystemClock : public Clock
+{
+public:
+    uint64_t Now() const override
+    {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+    }
+};
+
+}  // namespace ocra
@@ -0,0 +1,176 @@
+#include "hex.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OCRA_HEX_X86
+#endif
+
+
+namespace ocra
+{
+namespace
+{
+constexpr uint8_t INVALID = 0xff;
+
+struct NibbleTable
+{
+    constexpr NibbleTable() : values()
+    {
+        for (auto i = 0u; i < 256u; ++i)
+            values[i] = INVALID;
+        for (auto i = 0u; i < 10u; ++i)
+            values['0' + i] = static_cast<uint8_t>(i);
+        for (auto i = 0u; i < 6u; ++i)
+        {
+            values['A' + i] = static_cast<uint8_t>(10u + i);
+            values['a' + i] = static_cast<uint8_t>(10u + i);
+        }
+    }
+
+    uint8_t values[256];
+};
+
+constexpr NibbleTable NIBBLES{};
+
+inline uint8_t Nibble(char c)
+{
+    return NIBBLES.values[static_cast<uint8_t>(c)];
+}
+
+// Decodes character pairs, returns the count of decoded pairs
+using DecodePairs = std::size_t (*)(const char* hex, std::size_t pairs, uint8_t* output);
+
+std::size_t DecodePairsScalar(const char* hex, std::size_t pairs, uint8_t* output)
+{
+    for (auto i = 0u; i < pairs; ++i)
+    {
+        const auto high = Nibble(hex[2 * i]);
+        const auto low = Nibble(hex[2 * i + 1]);
+        if (high == INVALID || low == INVALID)
+            return i;
+        output[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return pairs;
+}
+
+#ifdef OCRA_HEX_X86
+// 16 characters into 8 bytes per step, 'high * 16 + low' of every pair with one maddubs
+__attribute__((target("ssse3")))
+std::size_t DecodePairsSsse3(const char* hex, std::size_t pairs, uint8_t* output)
+{
+    auto i = std::size_t{};
+    for (; i + 8u <= pairs; i += 8u)
+    {
+        // Digits are 'c - 0' below 10, letters of both cases are '(c | 0x20) - a' below 6
+        const auto characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i));
+        const auto digit = _mm_sub_epi8(characters, _mm_set1_epi8('0'));
+        const auto letter = _mm_sub_epi8(_mm_or_si128(characters, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const auto isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        const auto isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff)
+            break;
+
+        const auto nibbles = _mm_or_si128(_mm_and_si128(isDigit, digit),
+                                          _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+        const auto words = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(words, words));
+    }
+    return i + DecodePairsScalar(hex + 2 * i, pairs - i, output + i);
+}
+
+__attribute__((target("avx2")))
+std::size_t DecodePairsAvx2(const char* hex, std::size_t pairs, uint8_t* output)
+{
+    auto i = std::size_t{};
+    for (; i + 16u <= pairs; i += 16u)
+    {
+        const auto characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i));
+        const auto digit = _mm256_sub_epi8(characters, _mm256_set1_epi8('0'));
+        const auto letter = _mm256_sub_epi8(_mm256_or_si256(characters, _mm256_set1_epi8(0x20)),
+                                            _mm256_set1_epi8('a'));
+        const auto isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        const auto isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1)
+            break;
+
+        const auto nibbles = _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                                             _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+        const auto words = _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+        // packus works per 128-bit half, the permutation puts both 8-byte results together
+        const auto bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0xd8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm256_castsi256_si128(bytes));
+    }
+    return i + DecodePairsSsse3(hex + 2 * i, pairs - i, output + i);
+}
+
+DecodePairs SelectDecodePairs()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return DecodePairsAvx2;
+    else if (__builtin_cpu_supports("ssse3"))
+        return DecodePairsSsse3;
+    return DecodePairsScalar;
+}
+#else
+DecodePairs SelectDecodePairs()
+{
+    return DecodePairsScalar;
+}
+#endif
+
+const DecodePairs g_decodePairs = SelectDecodePairs();
+
+
+bool DecodeHexDigits(std::string_view hex, uint8_t* output)
+{
+    const auto pairs = hex.size() / 2;
+    if (g_decodePairs(hex.data(), pairs, output) != pairs)
+        return false;
+
+    if (hex.size() % 2)
+    {
+        const auto last = Nibble(hex.back());
+        if (last == INVALID)
+            return false;
+        output[pairs] = static_cast<uint8_t>(last << 4);
+    }
+    return true;
+}
+
+std::string_view SkipPrefix(std::string_view hex)
+{
+    if (hex.size() > 2 && hex[1] == 'x')
+        hex.remove_prefix(2);
+    return hex;
+}
+}  // namespace
+
+
+bool DecodeHex(std::string_view hex, uint8_t* output, bool isAlignRight)
+{
+    hex = SkipPrefix(hex);
+    return DecodeHexDigits(hex, output + ((hex.size() % 2) && isAlignRight));
+}
+
+bool IsHex(std::string_view hex)
+{
+    for (const auto c : SkipPrefix(hex))
+        if (Nibble(c) == INVALID)
+            return false;
+    return true;
+}
+
+bool DecodeHex(std::string_view hex, std::vector<uint8_t>& key)
+{
+    hex = SkipPrefix(hex);
+    key.resize((hex.size() + 1) / 2);
+    if (!DecodeHexDigits(hex, key.data()))
+    {
+        key.clear();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace ocra
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+#include <string_view>
+#include <vector>
+
+
+namespace ocra
+{
+// Decodes hex characters (upper or lower case) into 'output', two characters per byte,
+// an optional "0x" prefix is skipped. An odd count of characters leaves the low nibble of
+// the last byte empty, with 'isAlignRight' the bytes start one byte further (session info).
+// 'output' needs (size + 1) / 2 bytes, one more when aligned right. Returns false on the
+// first non-hex character, the bytes before it are already written
+bool DecodeHex(std::string_view hex, uint8_t* output, bool isAlignRight = false);
+
+// Whether 'hex' is what DecodeHex accepts, without decoding it
+bool IsHex(std::string_view hex);
+
+// Key import, 'key' is resized to the decoded bytes, left empty on failure
+bool DecodeHex(std::string_view hex, std::vector<uint8_t>& key);
+
+}  // namespace ocra
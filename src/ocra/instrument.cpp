@@ -0,0 +1,148 @@
+#include "instrument.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+
+namespace ocra
+{
+namespace
+{
+// Counters of one thread, written only by it with plain loads and stores, read by
+// CollectStatistics. A finished thread leaves its counters to the next new one
+struct ThreadStatistics
+{
+    std::atomic<uint64_t> calls[STAGE_COUNT];
+    std::atomic<uint64_t> errors[STAGE_COUNT];
+    std::atomic<uint64_t> timed[STAGE_COUNT];
+    std::atomic<uint64_t> ticks[STAGE_COUNT];
+    std::atomic<uint64_t> codes[Statistics::MAX_CODE];
+    std::atomic<bool> isUsed{true};
+    ThreadStatistics* next{};
+};
+
+// Only ever prepended, never removed, as the suites of 'intern.cpp'
+std::atomic<ThreadStatistics*> g_threads{};
+
+thread_local ThreadStatistics* t_statistics{};
+
+inline void Add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Gives the counters back when the thread finishes
+struct Release
+{
+    ~Release()
+    {
+        if (t_statistics)
+            t_statistics->isUsed.store(false, std::memory_order_release);
+    }
+};
+
+ThreadStatistics* Claim()
+{
+    thread_local Release release;
+    (void)release;
+
+    for (auto* node = g_threads.load(std::memory_order_acquire); node; node = node->next)
+    {
+        auto isUsed = false;
+        if (node->isUsed.compare_exchange_strong(isUsed, true, std::memory_order_acquire))
+            return node;
+    }
+
+    auto* node = new ThreadStatistics{};
+    node->next = g_threads.load(std::memory_order_relaxed);
+    while (!g_threads.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return node;
+}
+
+// Ticks of instrument::Now() at the start of the process, the base of their conversion
+struct Calibration
+{
+    uint64_t ticks = instrument::Now();
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+};
+
+const Calibration g_calibration;
+
+double NanosecondsPerTick()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    const auto ticks = instrument::Now() - g_calibration.ticks;
+    const auto elapsed = std::chrono::steady_clock::now() - g_calibration.time;
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return ticks ? static_cast<double>(nanoseconds) / ticks : 0.0;
+    #else
+    return std::chrono::steady_clock::period::num * 1e9 / std::chrono::steady_clock::period::den;
+    #endif
+}
+}  // namespace
+
+
+namespace instrument
+{
+uint64_t Start(Stage stage)
+{
+    if (!t_statistics)
+        t_statistics = Claim();
+
+    const auto calls = t_statistics->calls[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+    return calls % TIMING_PERIOD ? 0u : Now();
+}
+
+void Record(Stage stage, uint64_t start, int status)
+{
+    auto& statistics = *t_statistics;
+    const auto index = static_cast<std::size_t>(stage);
+    if (start)
+    {
+        Add(statistics.ticks[index], Now() - start);
+        Add(statistics.timed[index], 1u);
+    }
+
+    Add(statistics.calls[index], 1u);
+    if (status)
+    {
+        Add(statistics.errors[index], 1u);
+        if ((stage == Stage::Validate || stage == Stage::Call) && status > 0)
+            Add(statistics.codes[std::min<std::size_t>(status, Statistics::MAX_CODE - 1u)], 1u);
+    }
+}
+}  // namespace instrument
+
+
+Statistics CollectStatistics()
+{
+    auto result = Statistics{};
+    uint64_t timed[STAGE_COUNT] = {};
+    uint64_t ticks[STAGE_COUNT] = {};
+    for (auto* node = g_threads.load(std::memory_order_acquire); node; node = node->next)
+    {
+        for (auto i = 0u; i < STAGE_COUNT; ++i)
+        {
+            result.stages[i].calls += node->calls[i].load(std::memory_order_relaxed);
+            result.stages[i].errors += node->errors[i].load(std::memory_order_relaxed);
+            timed[i] += node->timed[i].load(std::memory_order_relaxed);
+            ticks[i] += node->ticks[i].load(std::memory_order_relaxed);
+        }
+        for (auto i = 0u; i < Statistics::MAX_CODE; ++i)
+            result.errors[i] += node->codes[i].load(std::memory_order_relaxed);
+    }
+
+    const auto nanosecondsPerTick = NanosecondsPerTick();
+    for (auto i = 0u; i < STAGE_COUNT; ++i)
+    {
+        if (timed[i])
+            result.stages[i].nanoseconds =
+                static_cast<uint64_t>(ticks[i] * nanosecondsPerTick * result.stages[i].calls / timed[i]);
+    }
+    return result;
+}
+
+}  // namespace ocra
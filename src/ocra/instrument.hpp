@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+
+namespace ocra
+{
+// Stages of operator() and Validate() measured with OCRA_INSTRUMENT. 'Call' is the whole
+// operator(), 'Assemble' includes 'PasswordHash' (the password digest of the provider)
+enum class Stage
+{
+    Validate,
+    Call,
+    Assemble,
+    PasswordHash,
+    Hmac,
+    Truncate
+};
+
+constexpr std::size_t STAGE_COUNT = 6u;
+
+
+// 'nanoseconds' is the time of all calls, estimated from the timed ones (see TIMING_PERIOD)
+struct StageStatistics
+{
+public:
+    uint64_t calls{};
+    uint64_t errors{};
+    uint64_t nanoseconds{};
+};
+
+
+// Sum of all threads at the time of the call, including the finished ones
+struct Statistics
+{
+public:
+    static constexpr std::size_t MAX_CODE = 0x40;
+
+    inline const StageStatistics& operator[](Stage stage) const { return stages[static_cast<std::size_t>(stage)]; }
+
+public:
+    StageStatistics stages[STAGE_COUNT];
+    // Failures of 'Validate' and 'Call' by their code, the codes above MAX_CODE in the last one
+    uint64_t errors[MAX_CODE] = {};
+};
+
+
+// Empty without OCRA_INSTRUMENT
+Statistics CollectStatistics();
+
+
+namespace instrument
+{
+// Every call is counted, one of TIMING_PERIOD calls of a stage in a thread is timed. Reading
+// the clock twice would cost more than the counting itself
+constexpr uint64_t TIMING_PERIOD = 16u;
+
+// Time-stamp counter on x86, converted to nanoseconds only by CollectStatistics
+inline uint64_t Now()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    #endif
+}
+
+// Start time of a call of 'stage' in the calling thread, 0 for a call which is not timed
+uint64_t Start(Stage stage);
+
+// Adds one call of 'stage' to the counters of the calling thread, a non-zero 'status' is its failure
+void Record(Stage stage, uint64_t start, int status);
+
+// Records the stage when it is left, also by an exception ('status' stays -1 then)
+class Scope
+{
+public:
+    explicit Scope(Stage stage) : m_stage{stage}, m_start{Start(stage)} {}
+    ~Scope() { Record(m_stage, m_start, m_status); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    inline void Status(int status) { m_status = status; }
+
+private:
+    Stage m_stage;
+    uint64_t m_start;
+    int m_status{-1};
+};
+}  // namespace instrument
+}  // namespace ocra
+
+
+// Instrumentation points, nothing without OCRA_INSTRUMENT:
+//     OCRA_STAGE(Hmac);
+//     ...
+//     OCRA_STAGE_STATUS(Hmac, status);
+#ifdef OCRA_INSTRUMENT
+#define OCRA_STAGE(stage) \
+    ::ocra::instrument::Scope ocraStage##stage{::ocra::Stage::stage}
+#define OCRA_STAGE_STATUS(stage, status) \
+    ocraStage##stage.Status(status)
+#else
+#define OCRA_STAGE(stage) do {} while(0)
+#define OCRA_STAGE_STATUS(stage, status) do {} while(0)
+#endif
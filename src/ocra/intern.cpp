@@ -0,0 +1,108 @@
+#include "intern.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <string>
+#include <utility>
+
+
+namespace ocra
+{
+
+namespace
+{
+struct Interned
+{
+public:
+    Interned(Ocra ocra, std::string_view suite, std::size_t hash)
+        : ocra{std::move(ocra)}
+        , key{suite}
+        , hash{hash}
+    {
+        for (auto& c : key)
+            c = toupper(c);
+    }
+
+public:
+    const Ocra ocra;
+    std::string key;
+    const std::size_t hash;
+    Interned* next{};
+};
+
+constexpr std::size_t BUCKETS = 1024u;
+
+// Nodes are only ever prepended, and never removed, so a reader walks a chain without locking
+std::atomic<Interned*> g_buckets[BUCKETS];
+
+
+// FNV-1a of the uppercased suite
+std::size_t Hash(std::string_view suite)
+{
+    auto hash = uint64_t{0xcbf29ce484222325};
+    for (const auto c : suite)
+    {
+        hash ^= static_cast<uint8_t>(toupper(c));
+        hash *= 0x100000001b3;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool IsEqual(const Interned& node, std::string_view suite, std::size_t hash)
+{
+    if (node.hash != hash || node.key.size() != suite.size())
+        return false;
+
+    for (auto i = 0u; i < suite.size(); ++i)
+        if (node.key[i] != toupper(suite[i]))
+            return false;
+    return true;
+}
+
+const Interned* Find(const Interned* node, const Interned* last, std::string_view suite, std::size_t hash)
+{
+    for (; node != last; node = node->next)
+        if (IsEqual(*node, suite, hash))
+            return node;
+    return nullptr;
+}
+}  // namespace
+
+
+const Ocra& Intern(std::string_view suite)
+{
+    const auto hash = Hash(suite);
+    auto& bucket = g_buckets[hash % BUCKETS];
+
+    auto* head = bucket.load(std::memory_order_acquire);
+    if (const auto* found = Find(head, nullptr, suite, hash))
+        return found->ocra;
+
+    // Validated outside of the table, only a valid suite is kept. A thread losing the race
+    // drops its own copy
+    auto ocra = Ocra(std::string(suite));
+    #ifdef OCRA_NO_THROW
+    if (ocra.Status())
+    {
+        thread_local Ocra invalid;
+        invalid = std::move(ocra);
+        return invalid;
+    }
+    #endif
+
+    auto* node = new Interned(std::move(ocra), suite, hash);
+    node->next = head;
+    while (!bucket.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                         std::memory_order_acquire))
+    {
+        if (const auto* found = Find(node->next, head, suite, hash))
+        {
+            delete node;
+            return found->ocra;
+        }
+        head = node->next;
+    }
+    return node->ocra;
+}
+
+}  // namespace ocra
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+
+#include "ocra.hpp"
+
+
+namespace ocra
+{
+// Process-wide table of parsed suites. A suite (in any letter case) is validated once and the
+// same immutable Ocra is shared by all threads, it lives until the process exits. Lookups are
+// lock-free, a new suite is added with a single compare-and-swap. An invalid suite is never
+// kept, it throws as the Ocra constructor. With OCRA_NO_THROW it is returned with its Status()
+// in an Ocra of the calling thread, valid until the next invalid suite of that thread
+const Ocra& Intern(std::string_view suite);
+
+}  // namespace ocra
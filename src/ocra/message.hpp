@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <inttypes.h>
+#include <string_view>
+
+#include "hex.hpp"
+#include "numeric.hpp"
+#include "ocra.hpp"
+
+
+namespace ocra
+{
+inline void StoreBE64(uint8_t* output, uint64_t value)
+{
+    for (auto i = 0u; i < 8u; ++i)
+        output[i] = (value >> (56 - 8 * i)) & 0xFF;
+}
+
+inline bool BuiltinPasswordHash(const char* password, std::size_t size, OcraSha shaType, uint8_t* digest)
+{
+    hash::Digest(static_cast<hash::Algorithm>(shaType),
+                 reinterpret_cast<const uint8_t*>(password), size, digest);
+    return true;
+}
+
+// Time depends only on the lengths, never on the position of the first difference
+inline bool IsEqualConstantTime(std::string_view left, std::string_view right)
+{
+    if (left.size() != right.size())
+        return false;
+
+    auto difference = 0u;
+    for (auto i = 0u; i < left.size(); ++i)
+        difference |= static_cast<uint8_t>(left[i] ^ right[i]);
+    return !difference;
+}
+
+// Offsets of the variable part of the message, without 'EvaluationPlan::assemble'
+constexpr EvaluationPlan LayoutMessage(const OcraSuite& suite, std::size_t suiteLength)
+{
+    constexpr auto EMPTY_BYTE = 1u;
+    constexpr auto COUNTER_LENGTH = 8u;
+    constexpr auto TIMESTAMP_LENGTH = 8u;
+
+    auto plan = EvaluationPlan{};
+    plan.prefixLength = suiteLength + EMPTY_BYTE;
+    plan.passwordSha = suite.passwordSha;
+    plan.passwordLength =
+        suite.passwordSha == OcraSha::None ? 0u :
+        hash::DigestSize(static_cast<hash::Algorithm>(suite.passwordSha));
+    plan.sessionLength = suite.sessionLength;
+
+    plan.counterOffset = 0u;
+    plan.questionOffset = plan.counterOffset + (suite.isCounter ? COUNTER_LENGTH : 0u);
+    plan.passwordOffset = plan.questionOffset + EvaluationPlan::QUESTION_LENGTH;
+    plan.sessionOffset = plan.passwordOffset + plan.passwordLength;
+    plan.timestampOffset = plan.sessionOffset + plan.sessionLength;
+    plan.length = plan.timestampOffset + (suite.timestamp.step ? TIMESTAMP_LENGTH : 0u);
+    return plan;
+}
+
+// Counts a request rejected by CheckParameters, see RejectedRequests
+void CountRejectedRequest();
+
+// Identity of a compiled plan, unique in the process. A prepared key remembers the plan
+// whose suite prefix it has absorbed
+uint64_t NewPlanIdentity();
+
+// Input stage of AssembleMessage, nothing is hashed before it passes: the inputs of the
+// suite are present, of their character class and fit their fields of the message
+template <char FORMAT, bool IS_COUNTER, bool IS_PASSWORD, bool IS_SESSION, bool IS_TIMESTAMP>
+int CheckParameters(const EvaluationPlan& plan, const OcraParametersView& parameters)
+{
+    constexpr auto QUESTION_LENGTH = EvaluationPlan::QUESTION_LENGTH;
+
+    if constexpr (IS_COUNTER)
+    {
+        if (!parameters.counter)
+            return 0x12;
+    }
+
+    if (parameters.questionBytes)
+    {
+        if (parameters.questionBytes->size() > QUESTION_LENGTH)
+            return 0x24;
+    }
+    else if (!parameters.question)
+        return 0x13;
+    else if constexpr (FORMAT == 'A')
+    {
+        if (parameters.question->length() > QUESTION_LENGTH)
+            return 0x26;
+    }
+    else if constexpr (FORMAT == 'H')
+    {
+        if (parameters.question->length() > 2 * QUESTION_LENGTH)
+            return 0x26;
+        if (!IsHex(*parameters.question))
+            return 0x1A;
+    }
+    else
+    {
+        // Too big a value is only known by encoding it
+        for (const auto c : *parameters.question)
+            if (c < '0' || c > '9')
+                return 0x15;
+    }
+
+    if constexpr (IS_PASSWORD)
+    {
+        if (parameters.passwordDigest)
+        {
+            if (parameters.passwordDigest->size() != plan.passwordLength)
+                return 0x23;
+        }
+        else if (!parameters.password)
+            return 0x16;
+    }
+
+    if constexpr (IS_SESSION)
+    {
+        if (parameters.sessionInfoBytes)
+        {
+            if (parameters.sessionInfoBytes->size() > plan.sessionLength)
+                return 0x25;
+        }
+        else if (!parameters.sessionInfo)
+            return 0x18;
+        else if (parameters.sessionInfo->length() > 2u * plan.sessionLength)
+            return 0x27;
+        else if (parameters.sessionInfo->length() < plan.sessionLength || !IsHex(*parameters.sessionInfo))
+            return 0x1A;
+    }
+
+    if constexpr (IS_TIMESTAMP)
+    {
+        if (!parameters.timestamp)
+            return 0x19;
+    }
+
+    return 0;
+}
+
+// CheckParameters counting the rejected requests, 'EvaluationPlan::check'
+template <char FORMAT, bool IS_COUNTER, bool IS_PASSWORD, bool IS_SESSION, bool IS_TIMESTAMP>
+int CheckMessage(const EvaluationPlan& plan, const OcraParametersView& parameters)
+{
+    const auto status = CheckParameters<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>(plan, parameters);
+    if (status)
+        CountRejectedRequest();
+    return status;
+}
+
+// Writes the variable part of the message of inputs passed by CheckMessage, 'EvaluationPlan::write'
+template <char FORMAT, bool IS_COUNTER, bool IS_PASSWORD, bool IS_SESSION, bool IS_TIMESTAMP>
+int WriteMessage(const EvaluationPlan& plan, uint8_t* message,
+                 const OcraParametersView& parameters,
+                 PasswordHashFunction passwordHash)
+{
+    constexpr auto QUESTION_LENGTH = EvaluationPlan::QUESTION_LENGTH;
+
+    if constexpr (IS_COUNTER)
+        StoreBE64(message + plan.counterOffset, *parameters.counter);
+
+    auto* question = message + plan.questionOffset;
+    memset(question, 0, QUESTION_LENGTH);
+    if (parameters.questionBytes)
+        memcpy(question, parameters.questionBytes->data(), parameters.questionBytes->size());
+    else if constexpr (FORMAT == 'A')
+        memcpy(question, parameters.question->data(), parameters.question->length());
+    else if constexpr (FORMAT == 'H')
+    {
+        if (!DecodeHex(*parameters.question, question))
+            return 0x1A;
+    }
+    else
+    {
+        if (EncodeNumericQuestion(*parameters.question, question, QUESTION_LENGTH) == SIZE_MAX)
+            return 0x15;
+    }
+
+    if constexpr (IS_PASSWORD)
+    {
+        if (parameters.passwordDigest)
+            memcpy(message + plan.passwordOffset, parameters.passwordDigest->data(), plan.passwordLength);
+        else if (!passwordHash(parameters.password->data(), parameters.password->size(),
+                               plan.passwordSha, message + plan.passwordOffset))
+            return 0x17;
+    }
+
+    if constexpr (IS_SESSION)
+    {
+        auto* session = message + plan.sessionOffset;
+        memset(session, 0, plan.sessionLength);
+        if (parameters.sessionInfoBytes)
+            memcpy(session, parameters.sessionInfoBytes->data(), parameters.sessionInfoBytes->size());
+        else
+        {
+            // Only the first 'sessionLength' characters are the session, aligned right. The
+            // bytes of an odd count start one byte further, which for a single character
+            // ('S001') is past the field, so it is decoded as the low nibble of the byte
+            constexpr auto isAlignRight = true;
+            const auto hex = parameters.sessionInfo->substr(0, plan.sessionLength);
+            if (plan.sessionLength > 1u)
+            {
+                if (!DecodeHex(hex, session, isAlignRight))
+                    return 0x1A;
+            }
+            else
+            {
+                const char digits[2] = {'0', hex[0]};
+                if (!DecodeHex(std::string_view(digits, 2u), session, isAlignRight))
+                    return 0x1A;
+            }
+        }
+    }
+
+    if constexpr (IS_TIMESTAMP)
+        StoreBE64(message + plan.timestampOffset, *parameters.timestamp);
+
+    return 0;
+}
+
+// Writes the variable part of the message laid out by 'plan', returns 0 or the failure code
+template <char FORMAT, bool IS_COUNTER, bool IS_PASSWORD, bool IS_SESSION, bool IS_TIMESTAMP>
+int AssembleMessage(const EvaluationPlan& plan, uint8_t* message,
+                    const OcraParametersView& parameters,
+                    PasswordHashFunction passwordHash)
+{
+    if (const auto status = CheckMessage<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>(plan, parameters))
+        return status;
+    return WriteMessage<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>(plan, message, parameters,
+                                                                                  passwordHash);
+}
+
+}  // namespace ocra
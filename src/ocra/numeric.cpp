@@ -0,0 +1,130 @@
+#include "numeric.hpp"
+
+#include <cstring>
+
+
+namespace ocra
+{
+namespace
+{
+__extension__ typedef unsigned __int128 Uint128;
+
+constexpr std::size_t CHUNK_DIGITS = 19u;
+constexpr std::size_t MAX_LIMBS = 16u;  // 1024 bits, the 128 bytes of the question
+
+constexpr uint64_t POWERS_OF_TEN[CHUNK_DIGITS + 1] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+    10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull};
+
+bool IsDigits8(const char* digits)
+{
+    uint64_t value;
+    memcpy(&value, digits, sizeof(value));
+    // Every byte must be in '0'..'9', the high nibble 3 and the low one below 10
+    return !(((value & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull) |
+             ((value + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull & ~0x3030303030303030ull));
+}
+
+// Eight ASCII digits to their value with three multiplications (little-endian load)
+uint64_t ParseDigits8(const char* digits)
+{
+    uint64_t value;
+    memcpy(&value, digits, sizeof(value));
+    value -= 0x3030303030303030ull;
+    value = (value * 10u) + (value >> 8);
+    value = (((value & 0x000000FF000000FFull) * (100u + (1000000ull << 32))) +
+             (((value >> 16) & 0x000000FF000000FFull) * (1u + (10000ull << 32)))) >> 32;
+    return value;
+}
+
+bool ParseChunk(const char* digits, std::size_t length, uint64_t& value)
+{
+    value = 0u;
+    for (; length >= 8u; digits += 8, length -= 8u)
+    {
+        if (!IsDigits8(digits))
+            return false;
+        value = value * 100000000u + ParseDigits8(digits);
+    }
+
+    for (; length; ++digits, --length)
+    {
+        if (*digits < '0' || '9' < *digits)
+            return false;
+        value = value * 10u + static_cast<uint64_t>(*digits - '0');
+    }
+    return true;
+}
+}  // namespace
+
+
+// The number is built in 64-bit limbs, one multiply-add pass per 19 digits,
+// instead of one long division pass per decimal digit
+std::size_t EncodeNumericQuestion(std::string_view decimal, uint8_t* output, std::size_t capacity)
+{
+    uint64_t limbs[MAX_LIMBS + 1] = {};  // little-endian, one spare limb for the nibble shift
+    auto used = std::size_t{};
+
+    auto chunk = decimal.size() % CHUNK_DIGITS ? decimal.size() % CHUNK_DIGITS : CHUNK_DIGITS;
+    for (auto position = std::size_t{}; position < decimal.size(); position += chunk, chunk = CHUNK_DIGITS)
+    {
+        auto carry = uint64_t{};
+        if (!ParseChunk(decimal.data() + position, chunk, carry))
+            return SIZE_MAX;
+
+        for (auto i = 0u; i < used; ++i)
+        {
+            const auto product = static_cast<Uint128>(limbs[i]) * POWERS_OF_TEN[chunk] + carry;
+            limbs[i] = static_cast<uint64_t>(product);
+            carry = static_cast<uint64_t>(product >> 64);
+        }
+
+        if (carry)
+        {
+            if (used == MAX_LIMBS)
+                return SIZE_MAX;
+            limbs[used++] = carry;
+        }
+    }
+
+    if (!used)
+        return 0u;
+
+    const auto topBits = 64u - static_cast<std::size_t>(__builtin_clzll(limbs[used - 1]));
+    const auto nibbles = (used - 1u) * 16u + (topBits + 3u) / 4u;
+    const auto bytes = (nibbles + 1u) / 2u;
+    if (bytes > capacity)
+        return SIZE_MAX;
+
+    // Left alignment, an odd hex digit count moves the number by one nibble
+    if (nibbles % 2u)
+    {
+        for (auto i = used + 1u; i-- > 1u;)
+            limbs[i] = (limbs[i] << 4) | (limbs[i - 1] >> 60);
+        limbs[0] <<= 4;
+    }
+
+    for (auto i = 0u; i < bytes; ++i)
+    {
+        const auto byte = bytes - 1u - i;
+        output[i] = static_cast<uint8_t>(limbs[byte / 8u] >> (8u * (byte % 8u)));
+    }
+    return bytes;
+}
+
+std::size_t EncodeNumericQuestions(Span<const std::string_view> questions, uint8_t* output,
+                                   std::size_t stride, Span<std::size_t> sizes)
+{
+    auto encoded = std::size_t{};
+    const auto count = questions.size() < sizes.size() ? questions.size() : sizes.size();
+    for (auto i = 0u; i < count; ++i, output += stride)
+    {
+        sizes[i] = EncodeNumericQuestion(questions[i], output, stride);
+        encoded += sizes[i] != SIZE_MAX;
+    }
+    return encoded;
+}
+
+}  // namespace ocra
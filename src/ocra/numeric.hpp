@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+#include <string_view>
+
+#include "span.hpp"
+
+
+namespace ocra
+{
+// Encodes the numeric ('QN') challenge as RFC6287 does: the number written in hexadecimal,
+// left-aligned and zero-padded, so an odd count of hex digits leaves the low nibble of the
+// last byte empty. Returns the count of written bytes, or SIZE_MAX when 'decimal' contains
+// other characters than digits or its value does not fit into 'capacity' bytes
+std::size_t EncodeNumericQuestion(std::string_view decimal, uint8_t* output, std::size_t capacity);
+
+// The same for many questions, question 'i' is written to 'output + i * stride' with at most
+// 'stride' bytes and its result stored in 'sizes[i]', returns the count of encoded questions
+std::size_t EncodeNumericQuestions(Span<const std::string_view> questions, uint8_t* output,
+                                   std::size_t stride, Span<std::size_t> sizes);
+
+}  // namespace ocra
@@ -1,15 +1,17 @@
 #include "ocra.hpp"
+#include "instrument.hpp"
+#include "message.hpp"
+#include "provider.hpp"
+#include "suiteparser.hpp"
+
+#include <atomic>
 
 
 #ifdef OCRA_NO_THROW
 #define THROW(code, message) \
-    do { m_status = code; return; } while(0)
+    do { (void)(message); m_status = code; return; } while(0)
 #define THROW_RETURN(code, message) \
-    do { m_status = code; return {}; } while(0)
-#define EXIT_WITH_STATUS() \
-    do { if (m_status) return; } while(0)
-#define EXIT_WITH_STATUS_RETURN() \
-    do { if (m_status) return {}; } while(0)
+    do { (void)(message); m_status = code; return {}; } while(0)
 #else
 #include <stdexcept>
 
@@ -23,36 +25,144 @@
 namespace ocra
 {
 
-std::string uint256DecToHex(const std::string& decimal)
+const char* ErrorMessage(int code)
 {
-    std::string result;
-    result.resize(65);
+    switch (code)
+    {
+        case 0x01: return "Invalid OCRA suite, pattern is: <Version>:<CryptoFunction>:<DataInput>, see RFC6287";
+        case 0x02: return "Invalid OCRA version, supported version is 1";
+        case 0x03: return "Invalid OCRA CryptoFunction, pattern is HOTP-SHAx-t, x = {1, 256, 512}, t = {0, 4-10}";
+        case 0x04: return "Invalid OCRA CryptoFunction, implementation supports only HOTP, pattern is HOTP-SHAx-t";
+        case 0x05: return "Invalid OCRA CryptoFunction, implementation supports SHA1, SHA256 or SHA512, pattern is HOTP-SHAx-t";
+        case 0x06: return "Invalid OCRA CryptoFunction, invalid 't' value, supported digits t = {0, 4-10}, pattern is HOTP-SHAx-t";
+        case 0x07: return "Unsupported data input format, for challenge data 'QFxx' wrong number of values, pattern is: Q[A|N|H][04-64]";
+        case 0x08: return "Unsupported data input format, for challenge data 'QFxx' unrecognized value of 'F', pattern is: Q[A|N|H][04-64]";
+        case 0x09: return "Unsupported data input format, for challenge data 'QFxx' value 'xx' is out of bound, pattern is: Q[A|N|H][04-64]";
+        case 0x0A: return "Unsupported data input format, invalid password descriptor 'PH', hash function must be SHA1, SHA256 or SHA512, pattern is: PSHA[1|256|512]";
+        case 0x0B: return "Unsupported data input format, invalid session data 'Snnn', pattern is: S[001-512]";
+        case 0x0C: return "Unsupported data input format, for session data 'Snnn' value 'nnn' is out of bound, pattern is: S[001-512]";
+        case 0x0D: return "Unsupported data input format, invalid timestamp data 'TG', pattern is: T[[1-59][S|M] | [0-48]H]";
+        case 0x0E: return "Unsupported data input format, invalid timestamp data 'TG', time-step must be S, M or H, pattern is: T[[1-59][S|M] | [0-48]H]";
+        case 0x0F: return "Unsupported data input format, for timestamp data 'TG' value 'G' is out of bound, pattern is: T[[1-59][S|M] | [0-48]H]";
+        case 0x10: return "OCRA operator() failed, missing parameter 'key', required for HMAC";
+        case 0x11: return "OCRA operator() failed, invalid HMAC result size, please check user defined HMACAlgorithm function";
+        case 0x12: return "OCRA operator() failed, suite contains a counter, but no counter value in parameters";
+        case 0x13: return "OCRA operator() failed, missing parameter 'question'";
+        case 0x15: return "OCRA operator() failed, question is Numeric, and must contains only digits '0' to '9'";
+        case 0x16: return "OCRA operator() failed, missing 'password' value";
+        case 0x17: return "OCRA operator() failed, password hashing failed, check user defined ShaHashing function";
+        case 0x18: return "OCRA operator() failed, no session info provided";
+        case 0x19: return "OCRA operator() failed, suite contains a timestamp, but no timestamp value in parameters";
+        case 0x1A: return "OCRA operator() failed, question is Hexadecimal, and must contains values [0-9][a-f][A-F]";
+        case 0x1B: return "Data input has missing first argument, please specify argument following the pattern: [C]-QFxx-[PH|Snnn|TG]";
+        case 0x1C: return "Data input has empty challenge argument, please specify argument following the pattern: [C]-QFxx-[PH|Snnn|TG]";
+        case 0x1D: return "Data input has missing challenge data 'QFxx', data input pattern is: [C]-QFxx-[PH|Snnn|TG]";
+        case 0x1E: return "Unsupported data input format, unexpected parameters left, data input pattern is: [C]-QFxx-[PH]-[Snnn]-[TG]";
+        case 0x1F: return "OCRA operator() failed, prepared key was created for a different HMAC algorithm";
+        case 0x20: return "OCRA Compute() failed, there are fewer results than parameters";
+        case 0x21: return "OCRA Verify() failed, suite does not contain a counter";
+        case 0x22: return "OCRA Verify() failed, suite does not contain a timestamp with non-zero time-step";
+        case 0x23: return "OCRA operator() failed, password digest size does not match the suite password hash";
+        case 0x24: return "OCRA operator() failed, question bytes are longer than 128 bytes";
+        case 0x25: return "OCRA operator() failed, session info bytes are longer than the suite session length";
+        case 0x26: return "OCRA operator() failed, question is longer than the 128 bytes of the challenge";
+        case 0x27: return "OCRA operator() failed, session info is longer than twice the suite session length";
+        case 0x28: return "OCRA Verify() failed, counter window runs past the largest counter value";
+        default: return "OCRA operator() failed";
+    }
+}
 
-    char* resultPtr = result.data();
-    char const* decimalPtr = decimal.data();
 
-    char x[64] = {};
-    int l = 0;
-    while (*decimalPtr)
+namespace
+{
+template <char FORMAT, bool... FLAGS>
+void SelectAssemble(const bool* flags, EvaluationPlan& plan)
+{
+    if constexpr (sizeof...(FLAGS) == 4)
     {
-        div_t d = { .quot = *decimalPtr++ - '0' };
-        for (int i = 0; i < l; ++i)
-        {
-            d = div(x[i]*10 + d.quot, 16);
-            x[i] = d.rem;
-        }
-
-        if (d.quot)
-            x[l++] = d.quot;
+        plan.assemble = AssembleMessage<FORMAT, FLAGS...>;
+        plan.check = CheckMessage<FORMAT, FLAGS...>;
+        plan.write = WriteMessage<FORMAT, FLAGS...>;
     }
-    
-    while (l--)
-        *resultPtr++ = x[l] + (10 <= x[l] ? 'A' - 10 : '0');
-    *resultPtr = 0;
-    return result;
+    else if (flags[sizeof...(FLAGS)])
+        SelectAssemble<FORMAT, FLAGS..., true>(flags, plan);
+    else
+        SelectAssemble<FORMAT, FLAGS..., false>(flags, plan);
 }
 
 
+// Reusable per-thread buffers of the hot path
+struct Scratch
+{
+    uint8_t message[EvaluationPlan::MAX_LENGTH];
+    uint8_t digest[hash::MAX_DIGEST_SIZE];
+    hash::HmacContext context;
+};
+
+thread_local Scratch g_scratch;
+
+
+// Lane messages of the batch Compute, each one starts with the suite prefix
+struct BatchScratch
+{
+    static constexpr std::size_t PREFIX_LENGTH = 128u;
+    static constexpr std::size_t MESSAGE_LENGTH = PREFIX_LENGTH + EvaluationPlan::MAX_LENGTH;
+
+    uint8_t messages[hash::MAX_LANES][MESSAGE_LENGTH];
+    uint8_t digests[hash::MAX_LANES][hash::MAX_DIGEST_SIZE];
+    const uint8_t* messagePointers[hash::MAX_LANES];
+    uint8_t* digestPointers[hash::MAX_LANES];
+    const uint8_t* keys[hash::MAX_LANES];
+    std::size_t keySizes[hash::MAX_LANES];
+    OtpResult* results[hash::MAX_LANES];
+};
+
+thread_local BatchScratch g_batchScratch;
+
+
+// Messages of the provider batch, a chunk of them goes to one 'HashProvider::Batch' call.
+// They are laid out one after another: CHUNK of them fit up to a suite prefix of
+// 'BatchScratch::PREFIX_LENGTH', fewer of a longer suite and at least one of the longest
+struct ProviderScratch
+{
+    static constexpr std::size_t CHUNK = 64u;
+    static constexpr std::size_t CAPACITY = std::max(CHUNK * BatchScratch::MESSAGE_LENGTH,
+                                                     std::size_t{UINT16_MAX} + EvaluationPlan::MAX_LENGTH);
+
+    static std::size_t Lanes(std::size_t size) { return std::min(CHUNK, CAPACITY / size); }
+
+    uint8_t messages[CAPACITY];
+    uint8_t digests[CHUNK][hash::MAX_DIGEST_SIZE];
+    Span<const uint8_t> keys[CHUNK];
+    Span<const uint8_t> messageSpans[CHUNK];
+    Span<uint8_t> digestSpans[CHUNK];
+    const uint8_t* digestPointers[CHUNK];
+    OtpResult* results[CHUNK];
+};
+
+thread_local ProviderScratch g_providerScratch;
+
+
+// Every thread counts on its own cache line, a flood of rejections does not share one
+struct alignas(64) RejectedCounter
+{
+    std::atomic<uint64_t> value{};
+};
+
+constexpr auto REJECTED_COUNTERS = 16u;
+RejectedCounter g_rejected[REJECTED_COUNTERS];
+std::atomic<unsigned> g_rejectedThreads{};
+
+std::atomic<uint64_t> g_planIdentities{};
+
+
+// Modulo of the truncated value for each OcraDigits
+constexpr int32_t DIGITS_MODULO[] = {1,      0,       0,        0,
+                                     10000,  100000,  1000000,  10000000,
+                                     100000000, 1000000000, INT32_MAX};
+}  // namespace
+
+
 std::string OcraSuite::to_string() const
 {
     auto result = std::string{};
@@ -136,12 +246,40 @@ std::string OcraSuite::to_string() const
 }
 
 
+void CountRejectedRequest()
+{
+    thread_local const auto index = g_rejectedThreads.fetch_add(1u, std::memory_order_relaxed) % REJECTED_COUNTERS;
+    g_rejected[index].value.fetch_add(1u, std::memory_order_relaxed);
+}
+
+uint64_t NewPlanIdentity()
+{
+    return g_planIdentities.fetch_add(1u, std::memory_order_relaxed) + 1u;
+}
+
+uint64_t RejectedRequests()
+{
+    auto count = uint64_t{};
+    for (const auto& counter : g_rejected)
+        count += counter.value.load(std::memory_order_relaxed);
+    return count;
+}
+
 Ocra::Ocra(std::string suite)
     : m_suiteStr{std::move(suite)}
 {
     Validate();
 }
 
+Expected<Ocra> Ocra::TryFrom(std::string suite)
+{
+    auto result = Ocra{};
+    result.m_suiteStr = std::move(suite);
+    if (const auto status = result.Parse())
+        return Expected<Ocra>::Failure(status);
+    return result;
+}
+
 Ocra& Ocra::From(std::string suite)
 {
     m_suiteStr = std::move(suite);
@@ -149,487 +287,702 @@ Ocra& Ocra::From(std::string suite)
     return *this;
 }
 
-std::string Ocra::operator()(const OcraParameters& parameters)
+PreparedKey::PreparedKey(Span<const uint8_t> key, OcraHmac hmac)
+    : m_context{static_cast<hash::Algorithm>(hmac), key.data(), key.size()}
+    , m_hmac{hmac}
+    , m_isEmpty{key.empty()}
 {
-    if (parameters.key.empty())
-        THROW_RETURN(0x10, "OCRA operator() failed, missing parameter 'key', required for HMAC");
-
-    constexpr auto QUESTION_LENGTH = 128u;
-    const auto PASSWORD_LENGTH =
-        m_suite.passwordSha == OcraSha::None ? 0u :
-        (m_suite.passwordSha == OcraSha::SHA1 ? 20u :
-        (m_suite.passwordSha == OcraSha::SHA256 ? 32u : 64u));
-    constexpr auto EMPTY_BYTE = 1u;
-
-    std::vector<uint8_t> message(
-        m_suiteStr.length() +
-        (m_suite.isCounter ? 8 : 0) +
-        QUESTION_LENGTH +
-        PASSWORD_LENGTH +
-        m_suite.sessionLength +
-        (m_suite.timestamp.step ? 8 : 0) +
-        EMPTY_BYTE);
-
-    auto pos = ConcatenateOcraSuite(message.data());
-    #ifdef OCRA_NO_THROW
-    pos += ConcatenateCounter(message.data() + pos, parameters);     EXIT_WITH_STATUS_RETURN();
-    pos += ConcatenateQuestion(message.data() + pos, parameters);    EXIT_WITH_STATUS_RETURN();
-    pos += ConcatenatePassword(message.data() + pos, parameters);    EXIT_WITH_STATUS_RETURN();
-    pos += ConcatenateSessionInfo(message.data() + pos, parameters); EXIT_WITH_STATUS_RETURN();
-    ConcatenateTimestamp(message.data() + pos, parameters);         EXIT_WITH_STATUS_RETURN();
-    #else
-    pos += ConcatenateCounter(message.data() + pos, parameters);
-    pos += ConcatenateQuestion(message.data() + pos, parameters);
-    pos += ConcatenatePassword(message.data() + pos, parameters);
-    pos += ConcatenateSessionInfo(message.data() + pos, parameters);
-    ConcatenateTimestamp(message.data() + pos, parameters);
-    #endif
-
-    const auto hash = user_implemented::HMACAlgorithm(message, parameters.key, m_suite.hmac);
-    if ((m_suite.hmac == OcraHmac::HOTP_SHA1 && hash.size() != 20u) ||
-        (m_suite.hmac == OcraHmac::HOTP_SHA256 && hash.size() != 32u) ||
-        (m_suite.hmac == OcraHmac::HOTP_SHA512 && hash.size() != 64u))
-        THROW_RETURN(0x11, "OCRA operator() failed, invalid HMAC result size, please check user defined HMACAlgorithm function");
-
-    const auto offset = hash[hash.size() - 1] & 0xf;
-    const auto binary =
-        ((hash[offset] & 0x7f) << 24) |
-        ((hash[offset + 1] & 0xff) << 16) |
-        ((hash[offset + 2] & 0xff) << 8) |
-        (hash[offset + 3] & 0xff);
-
-    constexpr int32_t DIGITS[] = {1,      0,       0,        0,
-                                  10000,  100000,  1000000,  10000000,
-                                  100000000, 1000000000, INT32_MAX};
-
-    const auto digits = static_cast<int>(m_suite.digits);
-    auto otp = binary % DIGITS[digits];
-    auto result = std::string((digits ? digits : 10), '0');
+}
 
-    int i = digits - 1;
-    for (; i >= 0 && otp; --i)
+PreparedKey Ocra::Prepare(Span<const uint8_t> key) const
+{
+    auto result = PreparedKey(key, m_suite.hmac);
+    if (m_plan.assemble)
     {
-        result[i] = '0' + (otp % 10);
-        otp /= 10;
+        result.m_prefixContext = result.m_context;
+        result.m_prefixContext.Update(reinterpret_cast<const uint8_t*>(m_suiteStr.c_str()),
+                                      m_plan.prefixLength);
+        result.m_prefixPlan = m_planIdentity;
     }
-    return digits ? result : result.substr(i);
+    return result;
 }
 
-std::size_t Ocra::ConcatenateOcraSuite(uint8_t* message)
+std::string Ocra::operator()(const OcraParametersView& parameters) const
 {
-    constexpr auto EMPTY_BYTE = 1u;
-    memcpy(message, (uint8_t*)m_suiteStr.c_str(), m_suiteStr.length());
-    return m_suiteStr.size() + EMPTY_BYTE;
+    OCRA_STAGE(Call);
+    auto result = OtpResult{};
+    const auto status = Call(parameters, result);
+    OCRA_STAGE_STATUS(Call, status);
+    #ifdef OCRA_NO_THROW
+    m_status = status;
+    #endif
+    if (status)
+        THROW_RETURN(status, ErrorMessage(status));
+    return std::string(result.View());
 }
 
-std::size_t Ocra::ConcatenateCounter(uint8_t* message,
-                                     const OcraParameters& parameters)
+std::string Ocra::operator()(const OcraParametersView& parameters, const PreparedKey& key) const
 {
-    constexpr auto NO_COUNTER_VALUE = 0u;
-    constexpr auto COUNTER_VALUE_AVAILABLE = 8u;
-
-    if (!m_suite.isCounter)
-        return NO_COUNTER_VALUE;
-        
-    if (!parameters.counter)
-        THROW_RETURN(0x12, "OCRA operator() failed, suite contains a counter, but no counter value in parameters");
-
-    message[0] = (*parameters.counter >> 56) & 0xFF;
-    message[1] = (*parameters.counter >> 48) & 0xFF;
-    message[2] = (*parameters.counter >> 40) & 0xFF;
-    message[3] = (*parameters.counter >> 32) & 0xFF;
-    message[4] = (*parameters.counter >> 24) & 0xFF;
-    message[5] = (*parameters.counter >> 16) & 0xFF;
-    message[6] = (*parameters.counter >> 8) & 0xFF;
-    message[7] = *parameters.counter & 0xFF;
-
-    return COUNTER_VALUE_AVAILABLE;
+    auto result = OtpResult{};
+    const auto status = Evaluate(parameters, key, result);
+    #ifdef OCRA_NO_THROW
+    m_status = status;
+    #endif
+    if (status)
+        THROW_RETURN(status, ErrorMessage(status));
+    return std::string(result.View());
 }
 
-std::size_t Ocra::ConcatenateQuestion(uint8_t* message,
-                                      const OcraParameters& parameters)
+std::size_t Ocra::operator()(Span<const OcraParameters> parameters, Span<OtpResult> results) const
 {
-    constexpr auto QUESTION_LENGTH = 128u;
+    if (CheckBatch(parameters.size(), results))
+        return 0u;
 
-    if (!parameters.question)
-        THROW_RETURN(0x13, "OCRA operator() failed, missing parameter 'question'");
-
-    if (m_suite.challenge.format == 'A')
+    OcraParametersView views[ProviderScratch::CHUNK];
+    auto computed = std::size_t{};
+    for (auto i = std::size_t{}; i < parameters.size(); i += ProviderScratch::CHUNK)
     {
-        memcpy(message, (uint8_t*)parameters.question->c_str(), parameters.question->length());
+        const auto count = std::min<std::size_t>(parameters.size() - i, ProviderScratch::CHUNK);
+        for (auto j = 0u; j < count; ++j)
+            views[j] = parameters[i + j];
+        computed += (*this)(Span<const OcraParametersView>(views, count), results.subspan(i, count));
     }
-    else if (m_suite.challenge.format == 'H')
+    return computed;
+}
+
+std::size_t Ocra::operator()(Span<const OcraParametersView> parameters, Span<OtpResult> results) const
+{
+    if (CheckBatch(parameters.size(), results))
+        return 0u;
+
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(m_suite.hmac));
+    const auto size = std::size_t{m_plan.prefixLength} + m_plan.length;
+    const auto lanes = ProviderScratch::Lanes(size);
+    auto& scratch = g_providerScratch;
+    for (auto l = 0u; l < lanes; ++l)
     {
-        StringHexToUint8(message, parameters.question->c_str(), parameters.question->length());
+        memcpy(scratch.messages + l * size, m_suiteStr.c_str(), m_plan.prefixLength);
+        scratch.messageSpans[l] = {scratch.messages + l * size, size};
+        scratch.digestSpans[l] = {scratch.digests[l], digestSize};
+        scratch.digestPointers[l] = scratch.digests[l];
     }
-    else if (m_suite.challenge.format == 'N')
+
+    // A failed call fails every request of its chunk, the provider does not tell which one
+    const auto& provider = Provider(m_suite.hmac);
+    auto computed = std::size_t{};
+    auto pending = std::size_t{};
+    const auto flush = [&]()
+    {
+        OCRA_STAGE(Hmac);
+        const auto isHashed = provider.Batch(pending, scratch.keys, scratch.messageSpans, scratch.digestSpans);
+        OCRA_STAGE_STATUS(Hmac, isHashed ? 0 : 0x11);
+        if (isHashed)
+        {
+            for (auto j = std::size_t{}; j < pending; j += hash::MAX_LANES)
+                TruncateLanes(scratch.digestPointers + j, std::min<std::size_t>(pending - j, hash::MAX_LANES),
+                              digestSize, scratch.results + j);
+            computed += pending;
+        }
+        else
+        {
+            for (auto j = 0u; j < pending; ++j)
+                scratch.results[j]->status = 0x11;
+        }
+        pending = 0u;
+    };
+
+    for (auto i = 0u; i < parameters.size(); ++i)
     {
-        for (const auto& c : *parameters.question)
+        const auto& request = parameters[i];
+        auto& result = results[i];
+        result = OtpResult{};
+        if (request.key.empty())
         {
-            if (c < '0' || '9' < c)
-                THROW_RETURN(0x15, "OCRA operator() failed, question is Numeric, and must contains only digits '0' to '9'");
+            result.status = 0x10;
+            continue;
         }
 
-        const auto questionHex = uint256DecToHex(*parameters.question);
-        StringHexToUint8(message, questionHex.c_str(), questionHex.length());
+        result.status = m_plan.assemble(m_plan, scratch.messages + pending * size + m_plan.prefixLength,
+                                        request, ProviderPasswordHash);
+        if (result.status)
+            continue;
+
+        scratch.keys[pending] = request.key;
+        scratch.results[pending] = &result;
+        if (++pending == lanes)
+            flush();
     }
 
-    return QUESTION_LENGTH;
+    if (pending)
+        flush();
+    return computed;
 }
 
-std::size_t Ocra::ConcatenatePassword(uint8_t* message,
-                                      const OcraParameters& parameters)
+OtpResult Ocra::TryCompute(const OcraParametersView& parameters, const PreparedKey& key) const
 {
-    constexpr auto NO_PASSWORD_VALUE = 0u;
-    const auto PASSWORD_LENGTH =
-        m_suite.passwordSha == OcraSha::SHA1 ? 20u :
-        (m_suite.passwordSha == OcraSha::SHA256 ? 32u : 64u);
-
-    if (m_suite.passwordSha == OcraSha::None)
-        return NO_PASSWORD_VALUE;
-
-    if (!parameters.password)
-        THROW_RETURN(0x16, "OCRA operator() failed, missing 'password' value");
-
-    const auto password = *parameters.password;
-    auto passwordVec = std::vector<uint8_t>(password.size());
-    memcpy((void*)passwordVec.data(), (void*)password.data(), password.size());
-
-    auto passwordHash = user_implemented::ShaHashing(passwordVec, m_suite.passwordSha);
-    if (passwordHash.size() != PASSWORD_LENGTH)
-        THROW_RETURN(0x17, "OCRA operator() failed, password hashing failed, check user defined ShaHashing function");
-
-    memcpy(message, passwordHash.data(), PASSWORD_LENGTH);
-    return PASSWORD_LENGTH;
+    auto result = OtpResult{};
+    result.status = Evaluate(parameters, key, result);
+    return result;
 }
 
-std::size_t Ocra::ConcatenateSessionInfo(uint8_t* message,
-                                         const OcraParameters& parameters)
+OtpResult Ocra::Compute(const OcraParametersView& parameters, const PreparedKey& key) const
 {
-    constexpr auto NO_SESSION_VALUE = 0u;
-    const auto SESSION_LENGTH = m_suite.sessionLength;
+    auto result = TryCompute(parameters, key);
+    #ifndef OCRA_NO_THROW
+    if (result.status)
+        throw std::invalid_argument(ErrorMessage(result.status));
+    #endif
+    return result;
+}
 
-    if (SESSION_LENGTH == 0)
-        return NO_SESSION_VALUE;
+OtpResult Ocra::TryCompute(const OcraParametersView& parameters) const
+{
+    auto result = OtpResult{};
+    result.status = Call(parameters, result);
+    return result;
+}
 
-    if (!parameters.sessionInfo)
-        THROW_RETURN(0x18, "OCRA operator() failed, no session info provided");
+OtpResult Ocra::Compute(const OcraParametersView& parameters) const
+{
+    auto result = TryCompute(parameters);
+    #ifndef OCRA_NO_THROW
+    if (result.status)
+        throw std::invalid_argument(ErrorMessage(result.status));
+    #endif
+    return result;
+}
 
-    constexpr auto isAlignRight = true;
-    if (parameters.sessionInfo->length() >= SESSION_LENGTH)
-    {
-        StringHexToUint8(message, parameters.sessionInfo->c_str(),
-                         SESSION_LENGTH, isAlignRight);
-    }
-    else
+std::size_t Ocra::Compute(Span<const OcraParameters> parameters, Span<OtpResult> results) const
+{
+    if (!IsBuiltinHmac(m_suite.hmac))
+        return (*this)(parameters, results);
+    if (CheckBatch(parameters.size(), results))
+        return 0u;
+
+    // Converted in groups of the lane count, each group fills the lanes as one batch
+    OcraParametersView views[hash::MAX_LANES];
+    auto computed = std::size_t{};
+    for (auto i = std::size_t{}; i < parameters.size(); i += hash::MAX_LANES)
     {
-        const auto offset = SESSION_LENGTH - parameters.sessionInfo->length();
-        StringHexToUint8(message + offset, parameters.sessionInfo->c_str(),
-                         SESSION_LENGTH, isAlignRight);
+        const auto count = std::min<std::size_t>(parameters.size() - i, hash::MAX_LANES);
+        for (auto j = 0u; j < count; ++j)
+            views[j] = parameters[i + j];
+        computed += Compute(Span<const OcraParametersView>(views, count), results.subspan(i, count));
     }
-    return SESSION_LENGTH;
+    return computed;
 }
 
-std::size_t Ocra::ConcatenateTimestamp(uint8_t* message,
-                                       const OcraParameters& parameters)
+int Ocra::CheckBatch(std::size_t count, Span<OtpResult> results) const
 {
-    constexpr auto NO_TIMESTAMP_VALUE = 0u;
-    constexpr auto TIMESTAMP_AVAILABLE = 8u;
-
-    if (!m_suite.timestamp.step)
-        return NO_TIMESTAMP_VALUE;
-        
-    if (!parameters.timestamp)
-        THROW_RETURN(0x19, "OCRA operator() failed, suite contains a timestamp, but no timestamp value in parameters");
-
-    message[0] = (*parameters.timestamp >> 56) & 0xFF;
-    message[1] = (*parameters.timestamp >> 48) & 0xFF;
-    message[2] = (*parameters.timestamp >> 40) & 0xFF;
-    message[3] = (*parameters.timestamp >> 32) & 0xFF;
-    message[4] = (*parameters.timestamp >> 24) & 0xFF;
-    message[5] = (*parameters.timestamp >> 16) & 0xFF;
-    message[6] = (*parameters.timestamp >> 8) & 0xFF;
-    message[7] = *parameters.timestamp & 0xFF;
-
-    return TIMESTAMP_AVAILABLE;
+    const auto status = !m_plan.assemble ? 0x01 : (results.size() < count ? 0x20 : 0);
+    if (status)
+    {
+        #ifndef OCRA_NO_THROW
+        throw std::invalid_argument(ErrorMessage(status));
+        #endif
+        for (auto& result : results)
+        {
+            result = OtpResult{};
+            result.status = status;
+        }
+    }
+    return status;
 }
 
-void Ocra::StringHexToUint8(uint8_t* output,
-                            const char* input,
-                            std::size_t length,
-                            bool isAlignRight)
+std::size_t Ocra::Compute(Span<const OcraParametersView> parameters, Span<OtpResult> results) const
 {
-    if (length > 2 && input[1] == 'x')
+    // The keys of a registered provider or batch function are not for the built-in engine
+    if (!IsBuiltinHmac(m_suite.hmac))
+        return (*this)(parameters, results);
+    if (CheckBatch(parameters.size(), results))
+        return 0u;
+
+    const auto algorithm = static_cast<hash::Algorithm>(m_suite.hmac);
+    const auto digestSize = hash::DigestSize(algorithm);
+    const auto size = m_plan.prefixLength + m_plan.length;
+    const auto lanes = m_plan.prefixLength <= BatchScratch::PREFIX_LENGTH ? hash::MAX_LANES : 1u;
+    auto& scratch = g_batchScratch;
+    for (auto l = 0u; l < lanes; ++l)
     {
-        length -= 2;
-        input += 2;
+        if (m_plan.prefixLength <= BatchScratch::PREFIX_LENGTH)
+            memcpy(scratch.messages[l], m_suiteStr.c_str(), m_plan.prefixLength);
+        scratch.messagePointers[l] = scratch.messages[l];
+        scratch.digestPointers[l] = scratch.digests[l];
     }
 
-    auto relativePos = std::size_t{(length % 2) && isAlignRight};
-
-    for (auto i = 0u; i < length; ++i)
+    // All messages of one suite have the same length, so every group fills the lanes evenly
+    auto computed = std::size_t{};
+    auto pending = std::size_t{};
+    const auto flush = [&]()
+    {
+        hash::HmacLanes(algorithm, pending, scratch.keys, scratch.keySizes,
+                        scratch.messagePointers, size, scratch.digestPointers);
+        TruncateLanes(scratch.digestPointers, pending, digestSize, scratch.results);
+        computed += pending;
+        pending = 0u;
+    };
+
+    for (auto i = 0u; i < parameters.size(); ++i)
     {
-        const auto& c = toupper(input[i]);
+        const auto& request = parameters[i];
+        auto& result = results[i];
+        result = OtpResult{};
+        if (request.key.empty())
+        {
+            result.status = 0x10;
+            continue;
+        }
 
-        if ('0' <= c  && c <= '9')
-            output[relativePos] |= (c - '0');
-        else if ('A' <= c  && c <= 'F')
-            output[relativePos] |= (10 + c - 'A');
-        else
-            THROW(0x1A, "OCRA operator() failed, question is Hexadecimal, and must contains values [0-9][a-f][A-F]");
+        // A suite longer than the lane buffers is hashed one request at a time
+        if (lanes == 1u)
+        {
+            result.status = Evaluate(request, result);
+            computed += !result.status;
+            continue;
+        }
 
-        if (i % 2)
-            ++relativePos;
-        else
-            output[relativePos] <<= 4;
+        result.status = m_plan.assemble(m_plan, scratch.messages[pending] + m_plan.prefixLength,
+                                        request, RegisteredPasswordHash);
+        if (result.status)
+            continue;
+
+        scratch.keys[pending] = request.key.data();
+        scratch.keySizes[pending] = request.key.size();
+        scratch.results[pending] = &result;
+        if (++pending == lanes)
+            flush();
     }
+
+    if (pending)
+        flush();
+    return computed;
 }
 
-void Ocra::Validate()
+VerifyResult Ocra::Verify(const OcraParametersView& parameters, std::string_view response, uint64_t window) const
 {
-    for (auto& c : m_suiteStr)
-        c = toupper(c);
-
-    constexpr auto OCRA_SUITE_SIZE = 3u;
-    auto [data, size] = split<3>(m_suiteStr, ':');
-    if (size != OCRA_SUITE_SIZE)
-        THROW(0x01, "Invalid OCRA suite, pattern is: <Version>:<CryptoFunction>:<DataInput>, see RFC6287");
-
-    auto version = std::move(data[0]);
-    auto function = std::move(data[1]);
-    auto dataInput = std::move(data[2]);
-
-    #ifdef OCRA_NO_THROW
-    ValidateVersion(std::move(version));            EXIT_WITH_STATUS();
-    ValidateCryptoFunction(std::move(function));    EXIT_WITH_STATUS();
-    ValidateDataInput(std::move(dataInput));        EXIT_WITH_STATUS();
-    #else
-    ValidateVersion(std::move(version));
-    ValidateCryptoFunction(std::move(function));
-    ValidateDataInput(std::move(dataInput));
+    const auto result = TryVerify(parameters, response, window);
+    #ifndef OCRA_NO_THROW
+    if (result.status)
+        throw std::invalid_argument(ErrorMessage(result.status));
     #endif
+    return result;
 }
 
-void Ocra::ValidateVersion(std::string version)
+VerifyResult Ocra::Verify(const OcraParametersView& parameters, std::string_view response,
+                          const Clock& clock, uint64_t drift) const
 {
-    constexpr auto OCRA_V1 = "OCRA-1";
-    if (version != OCRA_V1)
-        THROW(0x02, "Invalid OCRA version, supported version is 1");
-
-    m_suite.version = OcraVersion::OCRA_1;
+    const auto result = TryVerify(parameters, response, clock, drift);
+    #ifndef OCRA_NO_THROW
+    if (result.status)
+        throw std::invalid_argument(ErrorMessage(result.status));
+    #endif
+    return result;
 }
 
-void Ocra::ValidateCryptoFunction(std::string function)
+VerifyResult Ocra::TryVerify(const OcraParametersView& parameters, std::string_view response, uint64_t window) const
 {
-    constexpr auto CRYPTO_FUNCTION_PARTS = 3u;
-    auto [data, size] = split<3>(std::move(function), '-');
-    auto algorithm = std::move(data[0]);
-    auto hashFunc = std::move(data[1]);
-    auto digits = std::move(data[2]);
-
-    if (size != CRYPTO_FUNCTION_PARTS)
-        THROW(0x03, "Invalid OCRA CryptoFunction, pattern is HOTP-SHAx-t, x = {1, 256, 512}, t = {0, 4-10}");
-    
-    if (algorithm != "HOTP")
-        THROW(0x04, "Invalid OCRA CryptoFunction, implementation supports only HOTP, pattern is HOTP-SHAx-t");
-    
-    if (hashFunc == "SHA1")
-        m_suite.hmac = OcraHmac::HOTP_SHA1;
-    else if (hashFunc == "SHA256")
-        m_suite.hmac = OcraHmac::HOTP_SHA256;
-    else if (hashFunc == "SHA512")
-        m_suite.hmac = OcraHmac::HOTP_SHA512;
-    else
-        THROW(0x05, "Invalid OCRA CryptoFunction, implementation supports SHA1, SHA256 or SHA512, pattern is HOTP-SHAx-t");
-
-    if (digits == "0")
-        m_suite.digits = OcraDigits::_0;
-    else if (digits == "4")
-        m_suite.digits = OcraDigits::_4;
-    else if (digits == "5")
-        m_suite.digits = OcraDigits::_5;
-    else if (digits == "6")
-        m_suite.digits = OcraDigits::_6;
-    else if (digits == "7")
-        m_suite.digits = OcraDigits::_7;
-    else if (digits == "8")
-        m_suite.digits = OcraDigits::_8;
-    else if (digits == "9")
-        m_suite.digits = OcraDigits::_9;
-    else if (digits == "10")
-        m_suite.digits = OcraDigits::_10;
+    auto result = VerifyResult{};
+    if (!m_plan.assemble)
+        result.status = 0x01;
+    else if (!m_suite.isCounter)
+        result.status = 0x21;
+    else if (!parameters.counter)
+        result.status = 0x12;
+    else if (std::min(window, MAX_WINDOW) > UINT64_MAX - *parameters.counter)
+        result.status = 0x28;
     else
-        THROW(0x06, "Invalid OCRA CryptoFunction, invalid 't' value, supported digits t = {0, 4-10}, pattern is HOTP-SHAx-t");
-}
-
-void Ocra::ValidateDataInputChallenge(std::string challenge)
-{
-    challenge.erase(0, 1);
-
-    if (challenge.size() != 3)
-        THROW(0x07, "Unsupported data input format, for challenge data 'QFxx' wrong number of values, pattern is: Q[A|N|H][04-64]");
-
-    auto& format = m_suite.challenge.format;
-    auto& length = m_suite.challenge.length;
-    format = challenge.front();
-
-    if (format != 'A' && format != 'N' && format != 'H')
-        THROW(0x08, "Unsupported data input format, for challenge data 'QFxx' unrecognized value of 'F', pattern is: Q[A|N|H][04-64]");
+    {
+        const auto count = std::min(window, MAX_WINDOW) + 1u;
+        result.status = Scan(parameters, response, m_plan.counterOffset, *parameters.counter, count, result);
+    }
 
-    challenge.erase(0, 1);
-    length = atoi(challenge.c_str());
-    if (length < 4 || 64 < length)
-        THROW(0x09, "Unsupported data input format, for challenge data 'QFxx' value 'xx' is out of bound, pattern is: Q[A|N|H][04-64]");
+    return result;
 }
 
-void Ocra::ValidateDataInputPassword(std::string password)
+VerifyResult Ocra::TryVerify(const OcraParametersView& parameters, std::string_view response,
+                             const Clock& clock, uint64_t drift) const
 {
-    password.erase(0, 1);
-    if (password == "SHA1")
-        m_suite.passwordSha = OcraSha::SHA1;
-    else if (password == "SHA256")
-        m_suite.passwordSha = OcraSha::SHA256;
-    else if (password == "SHA512")
-        m_suite.passwordSha = OcraSha::SHA512;
+    auto result = VerifyResult{};
+    const auto seconds = m_suite.timestamp.Seconds();
+    if (!m_plan.assemble)
+        result.status = 0x01;
+    else if (!seconds)
+        result.status = 0x22;
     else
-        THROW(0x0A, "Unsupported data input format, invalid password descriptor 'PH', hash function must be SHA1, SHA256 or SHA512, pattern is: PSHA[1|256|512]");
-}
+    {
+        // The steps are limited to MAX_DRIFT on each side, so their count does not wrap
+        const auto now = clock.Now() / seconds;
+        const auto steps = std::min(drift, MAX_DRIFT);
+        const auto first = now < steps ? 0u : now - steps;
+        const auto last = UINT64_MAX - now < steps ? UINT64_MAX : now + steps;
+        const auto count = last - first + 1u;
+
+        // The timestamp bytes are rewritten anyway, only a missing value needs the copy
+        if (parameters.timestamp)
+            result.status = Scan(parameters, response, m_plan.timestampOffset, first, count, result);
+        else
+        {
+            auto timed = parameters;
+            timed.timestamp = now;
+            result.status = Scan(timed, response, m_plan.timestampOffset, first, count, result);
+        }
 
-void Ocra::ValidateDataInputSession(std::string sessioninfo)
-{
-    sessioninfo.erase(0, 1);
-    if (sessioninfo.size() != 3)
-        THROW(0x0B, "Unsupported data input format, invalid session data 'Snnn', pattern is: S[001-512]");
+        if (result.isMatch)
+        {
+            result.drift = static_cast<int64_t>(first + result.offset - now);
+            result.offset = 0u;
+        }
+    }
 
-    m_suite.sessionLength = atoi(sessioninfo.c_str());
-    if (m_suite.sessionLength < 1 || 512 < m_suite.sessionLength)
-        THROW(0x0C, "Unsupported data input format, for session data 'Snnn' value 'nnn' is out of bound, pattern is: S[001-512]");
+    return result;
 }
 
-void Ocra::ValidateDataInputTimestamp(std::string timestamp)
+// Assembles the message once and only rewrites the 8 bytes at 'offset' for every candidate,
+// groups of candidates go through the multi-buffer hash under a single key
+int Ocra::Scan(const OcraParametersView& parameters, std::string_view response, uint16_t offset,
+               uint64_t first, uint64_t count, VerifyResult& result) const
 {
-    timestamp.erase(0, 1);
-    if (timestamp.size() < 2 || 3 < timestamp.size())
-        THROW(0x0D, "Unsupported data input format, invalid timestamp data 'TG', pattern is: T[[1-59][S|M] | [0-48]H]");
+    if (parameters.key.empty())
+        return 0x10;
+    if (!IsBuiltinHmac(m_suite.hmac))
+        return ScanProvider(parameters, response, offset, first, count, result);
+
+    auto& scratch = g_batchScratch;
+    const auto isLanes = m_plan.prefixLength <= BatchScratch::PREFIX_LENGTH && count > 1u;
+    auto* message = isLanes ? scratch.messages[0] : g_scratch.message;
+    auto* tail = isLanes ? message + m_plan.prefixLength : message;
+    const auto status = m_plan.assemble(m_plan, tail, parameters, RegisteredPasswordHash);
+    if (status)
+        return status;
+
+    const auto algorithm = static_cast<hash::Algorithm>(m_suite.hmac);
+    const auto digestSize = hash::DigestSize(algorithm);
+    auto key = hash::HmacContext(algorithm, parameters.key.data(), parameters.key.size());
+    if (!isLanes)
+    {
+        auto prefixed = key;
+        prefixed.Update(reinterpret_cast<const uint8_t*>(m_suiteStr.c_str()), m_plan.prefixLength);
+        for (auto i = uint64_t{}; i < count; ++i)
+        {
+            StoreBE64(tail + offset, first + i);
+            auto& context = g_scratch.context;
+            context = prefixed;
+            context.Update(tail, m_plan.length);
+            context.Final(g_scratch.digest);
+
+            auto otp = OtpResult{};
+            Truncate(g_scratch.digest, digestSize, otp);
+            if (IsEqualConstantTime(otp.View(), response))
+            {
+                result.isMatch = true;
+                result.offset = i;
+                return 0;
+            }
+        }
+        return 0;
+    }
+
+    const auto size = m_plan.prefixLength + m_plan.length;
+    memcpy(message, m_suiteStr.c_str(), m_plan.prefixLength);
+    OtpResult otps[hash::MAX_LANES];
+    for (auto l = 0u; l < hash::MAX_LANES; ++l)
+    {
+        if (l)
+            memcpy(scratch.messages[l], message, size);
+        scratch.messagePointers[l] = scratch.messages[l];
+        scratch.digestPointers[l] = scratch.digests[l];
+        scratch.results[l] = &otps[l];
+    }
 
-    auto& step = m_suite.timestamp.step;
-    auto& time = m_suite.timestamp.time;
+    for (auto group = uint64_t{}; group < count; group += hash::MAX_LANES)
+    {
+        const auto lanes = count - group < hash::MAX_LANES ? count - group : hash::MAX_LANES;
+        for (auto l = 0u; l < lanes; ++l)
+            StoreBE64(scratch.messages[l] + m_plan.prefixLength + offset, first + group + l);
 
-    step = timestamp.back();
-    if (step != 'S' && step != 'M' && step != 'H')
-        THROW(0x0E, "Unsupported data input format, invalid timestamp data 'TG', time-step must be S, M or H, pattern is: T[[1-59][S|M] | [0-48]H]");
+        hash::HmacLanes(key, lanes, scratch.messagePointers, size, scratch.digestPointers);
+        TruncateLanes(scratch.digestPointers, lanes, digestSize, scratch.results);
 
-    timestamp.pop_back();
-    time = atoi(timestamp.c_str());
+        auto isMatch = false;
+        auto match = uint64_t{};
+        for (auto l = lanes; l--;)
+        {
+            const auto isEqual = IsEqualConstantTime(otps[l].View(), response);
+            match = isEqual ? l : match;
+            isMatch |= isEqual;
+        }
 
-    if (((step == 'S' || step == 'M') && (time < 1 || 59 < time)) || (time < 0 && 48 < time))
-        THROW(0x0F, "Unsupported data input format, for timestamp data 'TG' value 'G' is out of bound, pattern is: T[[1-59][S|M] | [0-48]H]");
+        if (isMatch)
+        {
+            result.isMatch = true;
+            result.offset = group + match;
+            return 0;
+        }
+    }
+    return 0;
 }
 
-bool Ocra::InsertCounterInputData(std::string value)
+// Scan with the registered providers, a chunk of candidates goes to one 'HashProvider::Batch' call
+int Ocra::ScanProvider(const OcraParametersView& parameters, std::string_view response, uint16_t offset,
+                       uint64_t first, uint64_t count, VerifyResult& result) const
 {
-    constexpr auto COUNTER_PARAM_CHAR = 'C';
-
-    if (value.empty())
+    auto& scratch = g_providerScratch;
+    const auto size = std::size_t{m_plan.prefixLength} + m_plan.length;
+    const auto chunk = ProviderScratch::Lanes(size);
+    auto* message = scratch.messages;
+    const auto status = m_plan.assemble(m_plan, message + m_plan.prefixLength, parameters, ProviderPasswordHash);
+    if (status)
+        return status;
+
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(m_suite.hmac));
+    memcpy(message, m_suiteStr.c_str(), m_plan.prefixLength);
+    OtpResult otps[ProviderScratch::CHUNK];
+    for (auto l = 0u; l < chunk; ++l)
     {
-        THROW_RETURN(0x1B, "Data input has missing first argument, please specify argument following the pattern: [C]-QFxx-[PH|Snnn|TG]");
+        if (l)
+            memcpy(message + l * size, message, size);
+        scratch.keys[l] = parameters.key;
+        scratch.messageSpans[l] = {message + l * size, size};
+        scratch.digestSpans[l] = {scratch.digests[l], digestSize};
+        scratch.digestPointers[l] = scratch.digests[l];
+        scratch.results[l] = &otps[l];
     }
-    else if (value[0] == COUNTER_PARAM_CHAR)
+
+    const auto& provider = Provider(m_suite.hmac);
+    for (auto group = uint64_t{}; group < count; group += chunk)
     {
-        m_suite.isCounter = true;
-        return true;
+        const auto lanes = static_cast<std::size_t>(std::min<uint64_t>(count - group, chunk));
+        for (auto l = 0u; l < lanes; ++l)
+            StoreBE64(message + l * size + m_plan.prefixLength + offset, first + group + l);
+
+        OCRA_STAGE(Hmac);
+        const auto isHashed = provider.Batch(lanes, scratch.keys, scratch.messageSpans, scratch.digestSpans);
+        OCRA_STAGE_STATUS(Hmac, isHashed ? 0 : 0x11);
+        if (!isHashed)
+            return 0x11;
+        for (auto j = std::size_t{}; j < lanes; j += hash::MAX_LANES)
+            TruncateLanes(scratch.digestPointers + j, std::min<std::size_t>(lanes - j, hash::MAX_LANES),
+                          digestSize, scratch.results + j);
+
+        auto isMatch = false;
+        auto match = uint64_t{};
+        for (auto l = lanes; l--;)
+        {
+            const auto isEqual = IsEqualConstantTime(otps[l].View(), response);
+            match = isEqual ? l : match;
+            isMatch |= isEqual;
+        }
+
+        if (isMatch)
+        {
+            result.isMatch = true;
+            result.offset = group + match;
+            return 0;
+        }
     }
-    return false;
+    return 0;
 }
 
-bool Ocra::InsertChallengeInputData(std::string value)
+int Ocra::Call(const OcraParametersView& parameters, OtpResult& result) const
 {
-    constexpr auto CHALLENGE_PARAM_CHAR = 'Q';
+    if (parameters.key.empty())
+        return 0x10;
 
-    if (value.empty())
-    {
-        THROW_RETURN(0x1C, "Data input has empty challenge argument, please specify argument following the pattern: [C]-QFxx-[PH|Snnn|TG]");
-    }
-    else if (value[0] == CHALLENGE_PARAM_CHAR)
+    if (!m_plan.assemble)
+        return 0x01;
+
+    auto& scratch = g_scratch;
     {
-        ValidateDataInputChallenge(std::move(value));
-        return true;
+        OCRA_STAGE(Assemble);
+        const auto status = m_plan.assemble(m_plan, scratch.message, parameters, ProviderPasswordHash);
+        OCRA_STAGE_STATUS(Assemble, status);
+        if (status)
+            return status;
     }
-    else
+
+    // The suite prefix and the variable part go to the provider as two pieces
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(m_suite.hmac));
     {
-        THROW_RETURN(0x1D, "Data input has missing challenge data 'QFxx', data input pattern is: [C]-QFxx-[PH|Snnn|TG]");
+        OCRA_STAGE(Hmac);
+        const auto& provider = Provider(m_suite.hmac);
+        HashProvider::State state;
+        const auto isInit = provider.Init(state, parameters.key);
+        if (isInit)
+        {
+            provider.Update(state, {reinterpret_cast<const uint8_t*>(m_suiteStr.c_str()), m_plan.prefixLength});
+            provider.Update(state, {scratch.message, m_plan.length});
+        }
+        const auto isHashed = provider.Final(state, {scratch.digest, digestSize}) && isInit;
+        OCRA_STAGE_STATUS(Hmac, isHashed ? 0 : 0x11);
+        if (!isHashed)
+            return 0x11;
     }
+
+    OCRA_STAGE(Truncate);
+    Truncate(scratch.digest, digestSize, result);
+    OCRA_STAGE_STATUS(Truncate, 0);
+    return 0;
 }
 
-bool Ocra::InsertPasswordInputData(std::string value)
+int Ocra::Evaluate(const OcraParametersView& parameters, const PreparedKey& key, OtpResult& result) const
 {
-    constexpr auto PASSWORD_PARAM_CHAR = 'P';
+    if (key.Empty())
+        return 0x10;
+
+    if (key.Hmac() != m_suite.hmac)
+        return 0x1F;
+
+    if (!m_plan.assemble)
+        return 0x01;
+
+    auto& scratch = g_scratch;
+    const auto status = m_plan.assemble(m_plan, scratch.message, parameters, RegisteredPasswordHash);
+    if (status)
+        return status;
+
+    // The key prepared by this suite has the constant prefix already absorbed
+    const auto isPrefixed = key.m_prefixPlan == m_planIdentity;
+    scratch.context = isPrefixed ? key.m_prefixContext : key.m_context;
+    if (!isPrefixed)
+        scratch.context.Update(reinterpret_cast<const uint8_t*>(m_suiteStr.c_str()), m_plan.prefixLength);
+    scratch.context.Update(scratch.message, m_plan.length);
+    scratch.context.Final(scratch.digest);
+
+    Truncate(scratch.digest, hash::DigestSize(scratch.context.GetAlgorithm()), result);
+    return 0;
+}
 
-    if (value.empty())
-    {
-        return false;
-    }
-    else if (value[0] == PASSWORD_PARAM_CHAR)
-    {
-        ValidateDataInputPassword(std::move(value));
-        return true;
-    }
-    return false;
+int Ocra::Evaluate(const OcraParametersView& parameters, OtpResult& result) const
+{
+    if (parameters.key.empty())
+        return 0x10;
+
+    if (!m_plan.assemble)
+        return 0x01;
+
+    auto& scratch = g_scratch;
+    const auto status = m_plan.assemble(m_plan, scratch.message, parameters, RegisteredPasswordHash);
+    if (status)
+        return status;
+
+    const auto algorithm = static_cast<hash::Algorithm>(m_suite.hmac);
+    scratch.context.Init(algorithm, parameters.key.data(), parameters.key.size());
+    scratch.context.Update(reinterpret_cast<const uint8_t*>(m_suiteStr.c_str()), m_plan.prefixLength);
+    scratch.context.Update(scratch.message, m_plan.length);
+    scratch.context.Final(scratch.digest);
+
+    Truncate(scratch.digest, hash::DigestSize(algorithm), result);
+    return 0;
 }
 
-bool Ocra::InsertSessionInputData(std::string value)
+void Ocra::Truncate(const uint8_t* hash, std::size_t size, OtpResult& result) const
 {
-    constexpr auto SESSION_PARAM_CHAR = 'S';
+    const auto offset = hash[size - 1] & 0xf;
+    const auto binary =
+        ((hash[offset] & 0x7f) << 24) |
+        ((hash[offset + 1] & 0xff) << 16) |
+        ((hash[offset + 2] & 0xff) << 8) |
+        (hash[offset + 3] & 0xff);
 
-    if (value.empty())
+    // No truncation digits (t = 0) gives the unpadded value, as in the RFC6287 reference
+    const auto digits = static_cast<int>(m_suite.digits);
+    auto otp = binary % DIGITS_MODULO[digits];
+    auto length = digits;
+    if (!digits)
     {
-        return false;
+        for (auto value = otp; value || !length; value /= 10)
+            ++length;
     }
-    else if (value[0] == SESSION_PARAM_CHAR)
+
+    for (auto i = length - 1; i >= 0; --i)
     {
-        ValidateDataInputSession(std::move(value));
-        return true;
+        result.value[i] = '0' + (otp % 10);
+        otp /= 10;
     }
-    return false;
+    result.value[length] = '\0';
+    result.length = length;
 }
 
-bool Ocra::InsertTimestampInputData(std::string value)
+// The lanes are processed digit by digit, so the division by 10 runs over all of them at once
+void Ocra::TruncateLanes(const uint8_t* const* hashes, std::size_t count, std::size_t size,
+                         OtpResult* const* results) const
 {
-    constexpr auto TIMESTAMP_PARAM_CHAR = 'T';
+    const auto digits = static_cast<std::size_t>(m_suite.digits);
+    if (!digits)
+    {
+        for (auto i = 0u; i < count; ++i)
+            Truncate(hashes[i], size, *results[i]);
+        return;
+    }
 
-    if (value.empty())
+    uint32_t otp[hash::MAX_LANES] = {};
+    for (auto i = 0u; i < count; ++i)
     {
-        return false;
+        uint32_t binary;
+        memcpy(&binary, hashes[i] + (hashes[i][size - 1] & 0xf), sizeof(binary));
+        otp[i] = (__builtin_bswap32(binary) & 0x7fffffff) % DIGITS_MODULO[digits];
+    }
+
+    char text[OtpResult::MAX_DIGITS][hash::MAX_LANES];
+    for (auto d = digits; d--;)
+    {
+        for (auto i = 0u; i < hash::MAX_LANES; ++i)
+        {
+            text[d][i] = static_cast<char>('0' + otp[i] % 10);
+            otp[i] /= 10;
+        }
     }
-    else if (value[0] == TIMESTAMP_PARAM_CHAR)
+
+    for (auto i = 0u; i < count; ++i)
     {
-        ValidateDataInputTimestamp(std::move(value));
-        return true;
+        auto& result = *results[i];
+        for (auto d = 0u; d < digits; ++d)
+            result.value[d] = text[d][i];
+        result.value[digits] = '\0';
+        result.length = static_cast<uint8_t>(digits);
     }
-    return false;
 }
 
-void Ocra::ValidateDataInput(std::string dataInput)
+void Ocra::Compile()
 {
-    auto input = 0u;
-    auto [data, size] = split<5>(std::move(dataInput), '-');
+    auto plan = LayoutMessage(m_suite, m_suiteStr.length());
+    const bool flags[] = {m_suite.isCounter, m_suite.passwordSha != OcraSha::None,
+                          m_suite.sessionLength > 0, m_suite.timestamp.step != 0};
+    if (m_suite.challenge.format == 'A')
+        SelectAssemble<'A'>(flags, plan);
+    else if (m_suite.challenge.format == 'H')
+        SelectAssemble<'H'>(flags, plan);
+    else
+        SelectAssemble<'N'>(flags, plan);
 
+    m_plan = plan;
+    m_planIdentity = NewPlanIdentity();
+}
+
+int Ocra::Parse()
+{
+    OCRA_STAGE(Validate);
+    m_plan = EvaluationPlan{};
+    m_planIdentity = 0u;
     #ifdef OCRA_NO_THROW
-    input += InsertCounterInputData(data[input]);               EXIT_WITH_STATUS();
-    input += InsertChallengeInputData(std::move(data[input]));  EXIT_WITH_STATUS();
-    input += InsertPasswordInputData(data[input]);              EXIT_WITH_STATUS();
-    input += InsertSessionInputData(data[input]);               EXIT_WITH_STATUS();
-    input += InsertTimestampInputData(data[input]);             EXIT_WITH_STATUS();
-    #else
-    input += InsertCounterInputData(data[input]);
-    input += InsertChallengeInputData(std::move(data[input]));
-    input += InsertPasswordInputData(data[input]);
-    input += InsertSessionInputData(data[input]);
-    input += InsertTimestampInputData(data[input]);
+    m_status = 0;
     #endif
 
-    if (input != size)
-        THROW(0x1E, "Unsupported data input format, unexpected parameters left, data input pattern is: [C]-QFxx-[PH]-[Snnn]-[TG]");
+    for (auto& c : m_suiteStr)
+        c = toupper(c);
+
+    const auto parsed = ParseSuite(m_suiteStr);
+    m_suite = parsed.suite;
+    if (!parsed.status)
+        Compile();
+    OCRA_STAGE_STATUS(Validate, parsed.status);
+    return parsed.status;
+}
+
+void Ocra::Validate()
+{
+    if (const auto status = Parse())
+        THROW(status, ErrorMessage(status));
 }
 
 }  // namespace ocra
@@ -1,13 +1,21 @@
 #pragma once
 
 #include <array>
+#ifdef OCRA_NO_THROW
+#include <atomic>
+#endif
 #include <cstring>
 #include <inttypes.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "clock.hpp"
+#include "hash/hash.hpp"
+#include "span.hpp"
+
 
 namespace ocra
 {
@@ -58,6 +66,12 @@ public:
     
     struct Timestamp
     {
+        // Length of one time-step in seconds, 0 for the suites without timestamp
+        constexpr uint64_t Seconds() const
+        {
+            return time * (step == 'H' ? 3600u : (step == 'M' ? 60u : (step == 'S' ? 1u : 0u)));
+        }
+
         char step = {};
         uint8_t time = {};
     };
@@ -77,8 +91,45 @@ public:
 };
 
 
+// Non-owning parameters of one computation, the data stays where the caller has it
+// (e.g. a network buffer), accepted by the whole computation path
+struct OcraParametersView
+{
+public:
+    Span<const uint8_t> key;
+    std::optional<uint64_t> counter;
+    std::optional<uint64_t> timestamp;
+    std::optional<std::string_view> password;
+    std::optional<std::string_view> question;
+    std::optional<std::string_view> sessionInfo;
+
+    // Binary inputs written into the message as they are, each one takes precedence over
+    // its text field: the digest of the password (of the suite PSHA size), the encoded
+    // challenge (up to 128 bytes, zero padded) and the session bytes (up to the suite
+    // session length, zero padded)
+    std::optional<Span<const uint8_t>> passwordDigest;
+    std::optional<Span<const uint8_t>> questionBytes;
+    std::optional<Span<const uint8_t>> sessionInfoBytes;
+};
+
+
 struct OcraParameters
 {
+public:
+    inline operator OcraParametersView() const
+    {
+        const auto view = [](const auto& value)
+        {
+            return value ? std::optional<std::string_view>(*value) : std::nullopt;
+        };
+        const auto bytes = [](const auto& value)
+        {
+            return value ? std::optional<Span<const uint8_t>>(*value) : std::nullopt;
+        };
+        return {key, counter, timestamp, view(password), view(question), view(sessionInfo),
+                bytes(passwordDigest), bytes(questionBytes), bytes(sessionInfoBytes)};
+    }
+
 public:
     std::vector<uint8_t> key;
     std::optional<uint64_t> counter;
@@ -86,85 +137,262 @@ public:
     std::optional<std::string> password;
     std::optional<std::string> question;
     std::optional<std::string> sessionInfo;
+    std::optional<std::vector<uint8_t>> passwordDigest;
+    std::optional<std::vector<uint8_t>> questionBytes;
+    std::optional<std::vector<uint8_t>> sessionInfoBytes;
+};
+
+
+// Fixed-capacity OTP, filled without any heap allocation
+struct OtpResult
+{
+public:
+    static constexpr std::size_t MAX_DIGITS = 10u;
+
+    inline std::string_view View() const { return {value, length}; }
+    inline explicit operator bool() const { return status == 0; }
+
+public:
+    char value[MAX_DIGITS + 1] = {};
+    uint8_t length{};
+    int status{};
+};
+
+
+// Outcome of Verify, 'offset' is the distance of the matching counter from the one in parameters,
+// 'drift' the number of time-steps between the matching timestamp and the clock
+struct VerifyResult
+{
+public:
+    inline explicit operator bool() const { return status == 0 && isMatch; }
+
+public:
+    bool isMatch{};
+    uint64_t offset{};
+    int64_t drift{};
+    int status{};
+};
+
+
+// A value or the failure code of producing it, available in every build
+template <typename T>
+class Expected
+{
+public:
+    Expected(T value) : m_value{std::move(value)} {}
+    static Expected Failure(int code) { return Expected{code}; }
+
+    inline explicit operator bool() const { return m_status == 0; }
+    inline bool HasValue() const { return m_status == 0; }
+    inline const T& Value() const& { return *m_value; }
+    inline T& Value() & { return *m_value; }
+    inline T&& Value() && { return std::move(*m_value); }
+    inline int Error() const { return m_status; }
+
+private:
+    explicit Expected(int code) : m_status{code} {}
+
+    std::optional<T> m_value;
+    int m_status{};
+};
+
+
+// Writes the password digest of 'shaType' into 'digest', returns false on failure
+using PasswordHashFunction = bool (*)(const char* password, std::size_t size,
+                                      OcraSha shaType, uint8_t* digest);
+
+
+// Message layout compiled by the suite validation, the message is the suite
+// prefix (suite string and the separator byte) followed by the variable part
+struct EvaluationPlan
+{
+public:
+    // Writes the variable part of the message, returns 0 or the failure code
+    using Assemble = int (*)(const EvaluationPlan& plan, uint8_t* message,
+                             const OcraParametersView& parameters,
+                             PasswordHashFunction passwordHash);
+    using Check = int (*)(const EvaluationPlan& plan, const OcraParametersView& parameters);
+
+    static constexpr std::size_t QUESTION_LENGTH = 128u;
+    static constexpr std::size_t MAX_LENGTH = 8u + QUESTION_LENGTH + 64u + 512u + 8u;
+
+public:
+    uint16_t prefixLength{};
+    uint16_t counterOffset{};
+    uint16_t questionOffset{};
+    uint16_t passwordOffset{};
+    uint16_t sessionOffset{};
+    uint16_t timestampOffset{};
+    uint16_t passwordLength{};
+    uint16_t sessionLength{};
+    uint16_t length{};
+    OcraSha passwordSha{OcraSha::None};
+    // 'assemble' is 'check' of the inputs followed by 'write' of the message
+    Assemble assemble{};
+    Check check{};
+    Assemble write{};
 };
 
 
+class PreparedKey
+{
+public:
+    PreparedKey() = default;
+    PreparedKey(Span<const uint8_t> key, OcraHmac hmac);
+    PreparedKey(const std::vector<uint8_t>& key, OcraHmac hmac) : PreparedKey(Span<const uint8_t>(key), hmac) {}
+
+    inline OcraHmac Hmac() const { return m_hmac; }
+    inline bool Empty() const { return m_isEmpty; }
+
+private:
+    friend class Ocra;
+    template <const char* SUITE> friend class StaticOcra;
+
+    hash::HmacContext m_context;
+    hash::HmacContext m_prefixContext;
+    // Plan of 'm_prefixContext', 0 for none
+    uint64_t m_prefixPlan{};
+    OcraHmac m_hmac{OcraHmac::HOTP_SHA1};
+    bool m_isEmpty{true};
+};
+
+
+namespace runtime
+{
+class AsyncOcra;
+class Pipeline;
+}  // namespace runtime
+
+
+#ifdef OCRA_NO_THROW
+// Code of the last operator() call of an Ocra (0 after a success) or of its validation,
+// copied as a plain value. The calls of an instance shared by threads overwrite each other's
+// code, they report failures only by 'TryCompute' and 'TryVerify'
+class FailureStatus
+{
+public:
+    FailureStatus() = default;
+    FailureStatus(const FailureStatus& other) : m_code{other} {}
+
+    FailureStatus& operator=(const FailureStatus& other) { return *this = static_cast<int>(other); }
+    FailureStatus& operator=(int code)
+    {
+        m_code.store(code, std::memory_order_relaxed);
+        return *this;
+    }
+
+    operator int() const { return m_code.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int> m_code{};
+};
+#endif
+
+
 class Ocra
 {
 public:
     explicit Ocra() = default;
     explicit Ocra(std::string suite);
 
+    // Validation which reports an invalid suite by the code only, in every build
+    static Expected<Ocra> TryFrom(std::string suite);
+
+    // Largest counter window and time-step drift (on each side of the clock) of Verify
+    static constexpr uint64_t MAX_WINDOW = 1024u;
+    static constexpr uint64_t MAX_DRIFT = 1024u;
+
     inline const OcraSuite& Suite() const { return m_suite; }
+    inline const EvaluationPlan& Plan() const { return m_plan; }
     Ocra& From(std::string suite);
     #ifdef OCRA_NO_THROW
     int Status() const { return m_status; }
     #endif
 
-    std::string operator()(const OcraParameters& parameters);
+    PreparedKey Prepare(Span<const uint8_t> key) const;
+
+    // Hashes with the registered providers, the 'user_implemented' functions by default
+    std::string operator()(const OcraParametersView& parameters) const;
+    std::string operator()(const OcraParametersView& parameters, const PreparedKey& key) const;
+
+    // Batch of requests with own keys for the providers, chunks of them are hashed by one
+    // 'HashProvider::Batch' call (see 'RegisterHmacBatch'). Failures are reported as by the
+    // batch Compute, a failed provider call fails all requests of its chunk with 0x11
+    std::size_t operator()(Span<const OcraParametersView> parameters, Span<OtpResult> results) const;
+    std::size_t operator()(Span<const OcraParameters> parameters, Span<OtpResult> results) const;
+
+    // Hot path, a steady-state call does not allocate
+    OtpResult Compute(const OcraParametersView& parameters, const PreparedKey& key) const;
+
+    // Counterpart of operator() with the result in a fixed buffer, hashes as operator()
+    // with the registered providers, failures are reported as by the prepared key one
+    OtpResult Compute(const OcraParametersView& parameters) const;
+
+    // Counterparts of Compute and Verify which never throw, also without OCRA_NO_THROW.
+    // A failure is only the code in 'status', no exception or message is made for it
+    OtpResult TryCompute(const OcraParametersView& parameters, const PreparedKey& key) const;
+    OtpResult TryCompute(const OcraParametersView& parameters) const;
+    VerifyResult TryVerify(const OcraParametersView& parameters, std::string_view response, uint64_t window) const;
+    VerifyResult TryVerify(const OcraParametersView& parameters, std::string_view response,
+                           const Clock& clock, uint64_t drift) const;
+
+    // Batch of requests with own keys ('OcraParameters::key'), hashed several at once
+    // by the multi-buffer kernels, or as by the batch operator() while another provider or a
+    // batch function is registered ('IsBuiltinHmac'). A failed request only sets its 'OtpResult::status',
+    // returns the number of computed codes
+    std::size_t Compute(Span<const OcraParametersView> parameters, Span<OtpResult> results) const;
+    std::size_t Compute(Span<const OcraParameters> parameters, Span<OtpResult> results) const;
+
+    // Server side check of a counter ('C') suite, tries the counters from 'parameters.counter'
+    // up to 'parameters.counter + window' and returns the first one matching the response.
+    // 'window' is limited to MAX_WINDOW, a range past the largest counter fails with 0x28.
+    // The candidates go to 'HashProvider::Batch' while the HMAC is not built-in ('IsBuiltinHmac')
+    VerifyResult Verify(const OcraParametersView& parameters, std::string_view response, uint64_t window) const;
+
+    // The same for a timestamp ('T') suite, tries the time-steps within 'drift' (at most
+    // MAX_DRIFT) around the clock, 'parameters.timestamp' is not used
+    VerifyResult Verify(const OcraParametersView& parameters, std::string_view response,
+                        const Clock& clock, uint64_t drift) const;
 
 private:
-    bool InsertChallengeInputData(std::string value);
-    bool InsertCounterInputData(std::string value);
-    bool InsertPasswordInputData(std::string value);
-    bool InsertSessionInputData(std::string value);
-    bool InsertTimestampInputData(std::string value);
-
-    std::size_t ConcatenateOcraSuite(uint8_t* message);
-    std::size_t ConcatenateCounter(uint8_t* message, const OcraParameters& parameters);
-    std::size_t ConcatenateQuestion(uint8_t* message, const OcraParameters& parameters);
-    std::size_t ConcatenatePassword(uint8_t* message, const OcraParameters& parameters);
-    std::size_t ConcatenateSessionInfo(uint8_t* message, const OcraParameters& parameters);
-    std::size_t ConcatenateTimestamp(uint8_t* message, const OcraParameters& parameters);
-
-    void StringHexToUint8(uint8_t* output, const char* input,
-                          std::size_t length, bool isAlignRight = false);
+    // Run the stages of the evaluation on their own threads or executor
+    friend class runtime::AsyncOcra;
+    friend class runtime::Pipeline;
 
-    void Validate();
-    void ValidateCryptoFunction(std::string function);
-    void ValidateDataInput(std::string dataInput);
-    void ValidateDataInputChallenge(std::string challenge);
-    void ValidateDataInputPassword(std::string password);
-    void ValidateDataInputSession(std::string sessioninfo);
-    void ValidateDataInputTimestamp(std::string timestamp);
-    void ValidateVersion(std::string version);
-
-    template <std::size_t N, typename T>
-    std::pair<std::array<std::string, N>, std::size_t> split(T&& data, char delimiter) const
-    {
-        auto result = std::array<std::string, N>{};
-        auto status = split<0>(result, data.c_str(), delimiter);
-        return std::make_pair(result, status);
-    }
+    int Call(const OcraParametersView& parameters, OtpResult& result) const;
+    int CheckBatch(std::size_t count, Span<OtpResult> results) const;
+    int Scan(const OcraParametersView& parameters, std::string_view response, uint16_t offset,
+             uint64_t first, uint64_t count, VerifyResult& result) const;
+    int ScanProvider(const OcraParametersView& parameters, std::string_view response, uint16_t offset,
+                     uint64_t first, uint64_t count, VerifyResult& result) const;
+    int Evaluate(const OcraParametersView& parameters, const PreparedKey& key, OtpResult& result) const;
+    int Evaluate(const OcraParametersView& parameters, OtpResult& result) const;
+    void Truncate(const uint8_t* hash, std::size_t size, OtpResult& result) const;
+    void TruncateLanes(const uint8_t* const* hashes, std::size_t count, std::size_t size,
+                       OtpResult* const* results) const;
 
-    template <std::size_t M, std::size_t N>
-    std::size_t split(std::array<std::string, N>& result, const char* data, char delimiter) const
-    {
-        if constexpr (M >= N)
-            return M + 1;
-        else if (data[0] == '\0')
-            return M + 1;
-        else
-        {
-            auto i = 0u;
-            while (data[i] != delimiter && data[i] != '\0') ++i;
-            result[M] = std::string(data, i);
-            if (data[i] == '\0')
-                return M + 1;
-            i += (data[i] == delimiter);
-            return split<M + 1>(result, data + i, delimiter);
-        }
-    }
+    int Parse();
+    void Validate();
+    void Compile();
 
 private:
     OcraSuite m_suite;
+    EvaluationPlan m_plan;
+    uint64_t m_planIdentity{};
     std::string m_suiteStr;
     #ifdef OCRA_NO_THROW
-    int m_status = {};
+    mutable FailureStatus m_status;
     #endif
 };
 
 
+// Description of a failure code of the evaluation ('OtpResult::status', 'VerifyResult::status')
+const char* ErrorMessage(int code);
+
+// Requests of all suites and threads rejected by the input checks, before anything was hashed
+uint64_t RejectedRequests();
+
+
 namespace user_implemented
 {
 std::vector<uint8_t> ShaHashing(const std::vector<uint8_t>& data,
@@ -0,0 +1,265 @@
+#include "provider.hpp"
+#include "instrument.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+
+namespace ocra
+{
+
+namespace
+{
+std::size_t Index(OcraHmac hmac)
+{
+    return hmac == OcraHmac::HOTP_SHA1 ? 0u : (hmac == OcraHmac::HOTP_SHA256 ? 1u : 2u);
+}
+
+std::size_t Index(OcraSha sha)
+{
+    return sha == OcraSha::SHA1 ? 0u : (sha == OcraSha::SHA256 ? 1u : 2u);
+}
+
+
+template <typename Context>
+class Builtin : public HashProvider
+{
+    static_assert(sizeof(Context) <= STATE_SIZE && alignof(Context) <= alignof(State));
+
+public:
+    explicit Builtin(hash::Algorithm algorithm) : m_algorithm{algorithm} {}
+
+    bool Init(State& state, Span<const uint8_t> key) const override
+    {
+        if constexpr (std::is_same_v<Context, hash::HmacContext>)
+            new (&state) Context(m_algorithm, key.data(), key.size());
+        else
+            new (&state) Context(m_algorithm);
+        return true;
+    }
+
+    void Update(State& state, Span<const uint8_t> data) const override
+    {
+        reinterpret_cast<Context*>(&state)->Update(data.data(), data.size());
+    }
+
+    bool Final(State& state, Span<uint8_t> digest) const override
+    {
+        if (digest.size() != hash::DigestSize(m_algorithm))
+            return false;
+        reinterpret_cast<Context*>(&state)->Final(digest.data());
+        return true;
+    }
+
+private:
+    hash::Algorithm m_algorithm;
+};
+
+
+std::atomic<HmacBatchFunction> g_hmacBatch{};
+
+
+// The message is gathered, the functions take it whole
+template <typename Type>
+class UserFunction : public HashProvider
+{
+    struct Message
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> key;
+    };
+    static_assert(sizeof(Message) <= STATE_SIZE && alignof(Message) <= alignof(State));
+
+public:
+    explicit UserFunction(Type type) : m_type{type} {}
+
+    bool Init(State& state, Span<const uint8_t> key) const override
+    {
+        new (&state) Message{{}, {key.begin(), key.end()}};
+        return true;
+    }
+
+    void Update(State& state, Span<const uint8_t> data) const override
+    {
+        auto& message = *reinterpret_cast<Message*>(&state);
+        message.data.insert(message.data.end(), data.begin(), data.end());
+    }
+
+    bool Final(State& state, Span<uint8_t> digest) const override
+    {
+        auto& message = *reinterpret_cast<Message*>(&state);
+        auto result = std::vector<uint8_t>{};
+        if constexpr (std::is_same_v<Type, OcraHmac>)
+            result = user_implemented::HMACAlgorithm(message.data, message.key, m_type);
+        else
+            result = user_implemented::ShaHashing(message.data, m_type);
+        message.~Message();
+
+        if (result.size() != digest.size())
+            return false;
+        memcpy(digest.data(), result.data(), result.size());
+        return true;
+    }
+
+    // One call of the registered batch function, otherwise HMACAlgorithm per message
+    bool Batch(std::size_t count, const Span<const uint8_t>* keys,
+               const Span<const uint8_t>* messages, const Span<uint8_t>* digests) const override
+    {
+        if constexpr (std::is_same_v<Type, OcraHmac>)
+        {
+            const auto function = g_hmacBatch.load(std::memory_order_acquire);
+            if (function)
+            {
+                // Chunks of the batch of operator() fit at once, a longer one takes several calls
+                thread_local HmacRequest requests[REQUESTS];
+                auto isSuccess = true;
+                for (auto i = std::size_t{}; i < count; i += REQUESTS)
+                {
+                    const auto size = std::min(count - i, REQUESTS);
+                    for (auto j = 0u; j < size; ++j)
+                        requests[j] = HmacRequest{messages[i + j], keys[i + j], m_type};
+                    isSuccess &= function(size, requests, digests + i);
+                }
+                return isSuccess;
+            }
+        }
+        return HashProvider::Batch(count, keys, messages, digests);
+    }
+
+private:
+    static constexpr std::size_t REQUESTS = 64u;
+
+    Type m_type;
+};
+
+
+const Builtin<hash::HmacContext> g_builtinHmac[] = {
+    Builtin<hash::HmacContext>{hash::Algorithm::SHA1},
+    Builtin<hash::HmacContext>{hash::Algorithm::SHA256},
+    Builtin<hash::HmacContext>{hash::Algorithm::SHA512}};
+
+const Builtin<hash::Context> g_builtinSha[] = {
+    Builtin<hash::Context>{hash::Algorithm::SHA1},
+    Builtin<hash::Context>{hash::Algorithm::SHA256},
+    Builtin<hash::Context>{hash::Algorithm::SHA512}};
+
+const UserFunction<OcraHmac> g_userHmac[] = {
+    UserFunction<OcraHmac>{OcraHmac::HOTP_SHA1},
+    UserFunction<OcraHmac>{OcraHmac::HOTP_SHA256},
+    UserFunction<OcraHmac>{OcraHmac::HOTP_SHA512}};
+
+const UserFunction<OcraSha> g_userSha[] = {
+    UserFunction<OcraSha>{OcraSha::SHA1},
+    UserFunction<OcraSha>{OcraSha::SHA256},
+    UserFunction<OcraSha>{OcraSha::SHA512}};
+
+std::atomic<const HashProvider*> g_hmacProviders[3] = {};
+std::atomic<const HashProvider*> g_shaProviders[3] = {};
+
+
+bool HashPassword(const HashProvider& provider, const char* password, std::size_t size, OcraSha shaType,
+                  uint8_t* digest)
+{
+    OCRA_STAGE(PasswordHash);
+    HashProvider::State state;
+    const auto isInit = provider.Init(state, {});
+    if (isInit)
+        provider.Update(state, {reinterpret_cast<const uint8_t*>(password), size});
+    const auto isHashed = provider.Final(state, {digest, hash::DigestSize(static_cast<hash::Algorithm>(shaType))}) && isInit;
+    OCRA_STAGE_STATUS(PasswordHash, isHashed ? 0 : 0x17);
+    return isHashed;
+}
+}  // namespace
+
+
+bool HashProvider::Batch(std::size_t count, const Span<const uint8_t>* keys,
+                         const Span<const uint8_t>* messages, const Span<uint8_t>* digests) const
+{
+    auto isSuccess = true;
+    for (auto i = 0u; i < count; ++i)
+    {
+        State state;
+        auto isInit = Init(state, keys[i]);
+        if (isInit)
+            Update(state, messages[i]);
+        isSuccess &= Final(state, digests[i]) && isInit;
+    }
+    return isSuccess;
+}
+
+const HashProvider& BuiltinProvider(OcraHmac hmac)
+{
+    return g_builtinHmac[Index(hmac)];
+}
+
+const HashProvider& BuiltinProvider(OcraSha sha)
+{
+    return g_builtinSha[Index(sha)];
+}
+
+const HashProvider& UserFunctionProvider(OcraHmac hmac)
+{
+    return g_userHmac[Index(hmac)];
+}
+
+const HashProvider& UserFunctionProvider(OcraSha sha)
+{
+    return g_userSha[Index(sha)];
+}
+
+void RegisterProvider(OcraHmac hmac, const HashProvider* provider)
+{
+    g_hmacProviders[Index(hmac)].store(provider, std::memory_order_release);
+}
+
+void RegisterProvider(OcraSha sha, const HashProvider* provider)
+{
+    g_shaProviders[Index(sha)].store(provider, std::memory_order_release);
+}
+
+void RegisterHmacBatch(HmacBatchFunction function)
+{
+    g_hmacBatch.store(function, std::memory_order_release);
+}
+
+HmacBatchFunction HmacBatch()
+{
+    return g_hmacBatch.load(std::memory_order_acquire);
+}
+
+const HashProvider& Provider(OcraHmac hmac)
+{
+    const auto* provider = g_hmacProviders[Index(hmac)].load(std::memory_order_acquire);
+    return provider ? *provider : UserFunctionProvider(hmac);
+}
+
+const HashProvider& Provider(OcraSha sha)
+{
+    const auto* provider = g_shaProviders[Index(sha)].load(std::memory_order_acquire);
+    return provider ? *provider : UserFunctionProvider(sha);
+}
+
+bool IsBuiltinHmac(OcraHmac hmac)
+{
+    const auto* provider = g_hmacProviders[Index(hmac)].load(std::memory_order_acquire);
+    return provider ? provider == &BuiltinProvider(hmac) : !HmacBatch();
+}
+
+bool ProviderPasswordHash(const char* password, std::size_t size, OcraSha shaType, uint8_t* digest)
+{
+    return HashPassword(Provider(shaType), password, size, shaType, digest);
+}
+
+bool RegisteredPasswordHash(const char* password, std::size_t size, OcraSha shaType, uint8_t* digest)
+{
+    const auto* provider = g_shaProviders[Index(shaType)].load(std::memory_order_acquire);
+    if (provider)
+        return HashPassword(*provider, password, size, shaType, digest);
+
+    hash::Digest(static_cast<hash::Algorithm>(shaType), reinterpret_cast<const uint8_t*>(password), size, digest);
+    return true;
+}
+
+}  // namespace ocra
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+#include <type_traits>
+
+#include "ocra.hpp"
+
+
+namespace ocra
+{
+// Hash implementation chosen at runtime for an 'OcraHmac' (HMAC of the message) or an
+// 'OcraSha' (digest of the password, 'key' is empty). The data is streamed: 'Init' starts
+// a message in 'state', owned by the caller, 'Update' adds its next piece and 'Final' writes
+// the digest. Every 'Init' is followed by 'Final', the key must stay valid until then.
+// A provider is shared by all threads, the per-message data lives only in 'state'
+class HashProvider
+{
+public:
+    static constexpr std::size_t STATE_SIZE = 512u;
+    using State = std::aligned_storage_t<STATE_SIZE, alignof(std::max_align_t)>;
+
+    virtual ~HashProvider() = default;
+
+    // Returns false on failure, 'Final' is still called then
+    virtual bool Init(State& state, Span<const uint8_t> key) const = 0;
+    virtual void Update(State& state, Span<const uint8_t> data) const = 0;
+    // Returns false on failure or when the digest does not fill 'digest' exactly
+    virtual bool Final(State& state, Span<uint8_t> digest) const = 0;
+
+    // Optional entry point for 'count' independent messages, the default streams them
+    // one by one. Returns false if any of them failed
+    virtual bool Batch(std::size_t count, const Span<const uint8_t>* keys,
+                       const Span<const uint8_t>* messages, const Span<uint8_t>* digests) const;
+};
+
+
+// The built-in hash engine ('src/hash')
+const HashProvider& BuiltinProvider(OcraHmac hmac);
+const HashProvider& BuiltinProvider(OcraSha sha);
+
+// The 'user_implemented' functions, the default providers
+const HashProvider& UserFunctionProvider(OcraHmac hmac);
+const HashProvider& UserFunctionProvider(OcraSha sha);
+
+// Provider used by operator() from now on, 'nullptr' restores the default one. The provider
+// must outlive its use, registration is atomic and does not stop the running computations
+void RegisterProvider(OcraHmac hmac, const HashProvider* provider);
+void RegisterProvider(OcraSha sha, const HashProvider* provider);
+
+const HashProvider& Provider(OcraHmac hmac);
+const HashProvider& Provider(OcraSha sha);
+
+
+// One message of a batched HMAC call, 'key' may be the handle of a key kept by the module
+struct HmacRequest
+{
+public:
+    Span<const uint8_t> message;
+    Span<const uint8_t> key;
+    OcraHmac hmac;
+};
+
+// Optional counterpart of 'user_implemented::HMACAlgorithm' for 'count' messages at once,
+// e.g. one round trip to a signing module. Writes the digest of 'requests[i]' to 'digests[i]'
+// (of the digest size of its 'hmac'), returns false if any of them failed
+using HmacBatchFunction = bool (*)(std::size_t count, const HmacRequest* requests, const Span<uint8_t>* digests);
+
+// Function used by 'Batch' of the default HMAC providers from now on, 'nullptr' restores
+// one HMACAlgorithm call per message. Registration is atomic as of the providers
+void RegisterHmacBatch(HmacBatchFunction function);
+
+// The registered batch function, 'nullptr' without one. Its keys may be handles of a module,
+// so with it the built-in engine is not used for the HMAC and the requests go to 'Provider'
+HmacBatchFunction HmacBatch();
+
+// Whether Verify, the batch Compute and the pipeline hash by the built-in engine: its provider
+// is registered, or none is and no batch function is. Otherwise they go to 'Provider' as operator()
+bool IsBuiltinHmac(OcraHmac hmac);
+
+// Password digest of operator(), by 'Provider'
+bool ProviderPasswordHash(const char* password, std::size_t size, OcraSha shaType, uint8_t* digest);
+
+// Password digest of the paths hashing by the built-in engine, by the registered provider or
+// by the engine in place of the 'user_implemented' function
+bool RegisteredPasswordHash(const char* password, std::size_t size, OcraSha shaType, uint8_t* digest);
+
+}  // namespace ocra
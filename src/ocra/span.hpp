@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+
+namespace ocra
+{
+// Non-owning view over contiguous objects, a C++17 stand-in for std::span,
+// the member names follow the standard so it works with range-for and algorithms
+template <typename T>
+class Span
+{
+public:
+    constexpr Span() = default;
+    constexpr Span(T* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    template <std::size_t N>
+    constexpr Span(T (&data)[N]) : m_data(data), m_size(N) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+    Span(std::vector<U>& data) : m_data(data.data()), m_size(data.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U(*)[], T(*)[]>>>
+    Span(const std::vector<U>& data) : m_data(data.data()), m_size(data.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+    constexpr Span(const Span<U>& other) : m_data(other.data()), m_size(other.size()) {}
+
+    constexpr T* data() const { return m_data; }
+    constexpr std::size_t size() const { return m_size; }
+    constexpr bool empty() const { return !m_size; }
+    constexpr T* begin() const { return m_data; }
+    constexpr T* end() const { return m_data + m_size; }
+    constexpr T& operator[](std::size_t index) const { return m_data[index]; }
+
+    constexpr Span subspan(std::size_t offset, std::size_t count) const { return {m_data + offset, count}; }
+
+private:
+    T* m_data{};
+    std::size_t m_size{};
+};
+
+}  // namespace ocra
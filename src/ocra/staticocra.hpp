@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifndef OCRA_NO_THROW
+#include <stdexcept>
+#endif
+
+#include "message.hpp"
+#include "ocra.hpp"
+#include "suiteparser.hpp"
+
+
+namespace ocra
+{
+// Suite fixed at compile time, an invalid suite does not compile:
+//     static constexpr char SUITE[] = "OCRA-1:HOTP-SHA1-6:QN08";
+//     const auto otp = StaticOcra<SUITE>::Compute(parameters, StaticOcra<SUITE>::Prepare(key));
+// The message layout, HMAC and truncation are constants, the codes and failures are the
+// same as of Ocra, and the keys prepared by both are interchangeable
+template <const char* SUITE>
+class StaticOcra
+{
+private:
+    static constexpr auto PARSED = ParseSuite(SUITE);
+    static_assert(PARSED.status == 0, "Invalid OCRA suite, see RFC6287");
+
+    static constexpr auto SUITE_LENGTH = std::string_view(SUITE).size();
+
+    static constexpr auto PREFIX = []()
+    {
+        auto prefix = std::array<char, SUITE_LENGTH + 1u>{};
+        for (auto i = 0u; i < SUITE_LENGTH; ++i)
+            prefix[i] = parser::ToUpper(SUITE[i]);
+        return prefix;
+    }();
+
+    static constexpr auto FORMAT = PARSED.suite.challenge.format;
+    static constexpr auto IS_COUNTER = PARSED.suite.isCounter;
+    static constexpr auto IS_PASSWORD = PARSED.suite.passwordSha != OcraSha::None;
+    static constexpr auto IS_SESSION = PARSED.suite.sessionLength != 0u;
+    static constexpr auto IS_TIMESTAMP = PARSED.suite.timestamp.step != 0;
+
+    static constexpr auto ASSEMBLE = AssembleMessage<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>;
+
+    static constexpr auto PLAN = []()
+    {
+        auto plan = LayoutMessage(PARSED.suite, SUITE_LENGTH);
+        plan.assemble = ASSEMBLE;
+        plan.check = CheckMessage<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>;
+        plan.write = WriteMessage<FORMAT, IS_COUNTER, IS_PASSWORD, IS_SESSION, IS_TIMESTAMP>;
+        return plan;
+    }();
+
+    static constexpr auto ALGORITHM = static_cast<hash::Algorithm>(PARSED.suite.hmac);
+    static constexpr auto DIGEST_SIZE = hash::DigestSize(ALGORITHM);
+    static constexpr auto DIGITS = static_cast<int>(PARSED.suite.digits);
+    static constexpr auto LENGTH = DIGITS ? DIGITS : 1;
+
+    // As Ocra, no truncation digits (t = 0) keep nothing of the value but a single '0'
+    static constexpr auto MODULO = []()
+    {
+        auto modulo = int32_t{1};
+        for (auto i = 0; i < DIGITS; ++i)
+            modulo = DIGITS == 10 ? INT32_MAX : modulo * 10;
+        return modulo;
+    }();
+
+public:
+    static constexpr const OcraSuite& Suite() { return PARSED.suite; }
+    static constexpr const EvaluationPlan& Plan() { return PLAN; }
+
+    static PreparedKey Prepare(Span<const uint8_t> key)
+    {
+        auto result = PreparedKey(key, PARSED.suite.hmac);
+        result.m_prefixContext = result.m_context;
+        result.m_prefixContext.Update(reinterpret_cast<const uint8_t*>(PREFIX.data()), PLAN.prefixLength);
+        result.m_prefixPlan = PlanIdentity();
+        return result;
+    }
+
+    static OtpResult TryCompute(const OcraParametersView& parameters, const PreparedKey& key)
+    {
+        auto result = OtpResult{};
+        result.status = Evaluate(parameters, key, result);
+        return result;
+    }
+
+    static OtpResult Compute(const OcraParametersView& parameters, const PreparedKey& key)
+    {
+        auto result = TryCompute(parameters, key);
+        #ifndef OCRA_NO_THROW
+        if (result.status)
+            throw std::invalid_argument(ErrorMessage(result.status));
+        #endif
+        return result;
+    }
+
+    std::string operator()(const OcraParametersView& parameters, const PreparedKey& key) const
+    {
+        return std::string(Compute(parameters, key).View());
+    }
+
+private:
+    static uint64_t PlanIdentity()
+    {
+        static const auto identity = NewPlanIdentity();
+        return identity;
+    }
+
+    static int Evaluate(const OcraParametersView& parameters, const PreparedKey& key, OtpResult& result)
+    {
+        if (key.Empty())
+            return 0x10;
+
+        if (key.Hmac() != PARSED.suite.hmac)
+            return 0x1F;
+
+        uint8_t message[PLAN.length];
+        const auto status = ASSEMBLE(PLAN, message, parameters, BuiltinPasswordHash);
+        if (status)
+            return status;
+
+        const auto isPrefixed = key.m_prefixPlan == PlanIdentity();
+        auto context = isPrefixed ? key.m_prefixContext : key.m_context;
+        if (!isPrefixed)
+            context.Update(reinterpret_cast<const uint8_t*>(PREFIX.data()), PLAN.prefixLength);
+        context.Update(message, PLAN.length);
+
+        uint8_t digest[DIGEST_SIZE];
+        context.Final(digest);
+        Truncate(digest, result);
+        return 0;
+    }
+
+    static void Truncate(const uint8_t* hash, OtpResult& result)
+    {
+        const auto offset = hash[DIGEST_SIZE - 1] & 0xf;
+        const auto binary =
+            ((hash[offset] & 0x7f) << 24) |
+            ((hash[offset + 1] & 0xff) << 16) |
+            ((hash[offset + 2] & 0xff) << 8) |
+            (hash[offset + 3] & 0xff);
+
+        auto otp = binary % MODULO;
+        for (auto i = LENGTH - 1; i >= 0; --i)
+        {
+            result.value[i] = '0' + (otp % 10);
+            otp /= 10;
+        }
+        result.value[LENGTH] = '\0';
+        result.length = LENGTH;
+    }
+};
+
+}  // namespace ocra
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "ocra.hpp"
+
+
+namespace ocra
+{
+struct SuiteParseResult
+{
+public:
+    OcraSuite suite{};
+    int status{};
+};
+
+
+namespace parser
+{
+constexpr char ToUpper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+constexpr bool IsEqual(std::string_view value, std::string_view expected)
+{
+    if (value.size() != expected.size())
+        return false;
+    for (auto i = 0u; i < value.size(); ++i)
+        if (ToUpper(value[i]) != expected[i])
+            return false;
+    return true;
+}
+
+// Leading whitespace, sign and digits, as std::atoi
+constexpr int ToInt(std::string_view value)
+{
+    auto i = std::size_t{};
+    while (i < value.size() && (value[i] == ' ' || (value[i] >= '\t' && value[i] <= '\r')))
+        ++i;
+
+    auto sign = 1;
+    if (i < value.size() && (value[i] == '+' || value[i] == '-'))
+        sign = value[i++] == '-' ? -1 : 1;
+
+    auto result = 0;
+    for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i)
+        result = 10 * result + (value[i] - '0');
+    return sign * result;
+}
+
+// Splits into at most N parts, returns N + 1 when there are more of them. An empty rest
+// after the delimiter is one more empty part
+template <std::size_t N>
+constexpr std::size_t Split(std::string_view data, char delimiter, std::string_view (&parts)[N])
+{
+    for (auto m = std::size_t{}; ; ++m)
+    {
+        if (m >= N)
+            return N + 1;
+        if (data.empty())
+            return m + 1;
+
+        const auto i = data.find(delimiter);
+        parts[m] = data.substr(0, i);
+        if (i == std::string_view::npos)
+            return m + 1;
+        data.remove_prefix(i + 1);
+    }
+}
+
+constexpr int ParseCryptoFunction(std::string_view function, OcraSuite& suite)
+{
+    std::string_view parts[3] = {};
+    if (Split(function, '-', parts) != 3u)
+        return 0x03;
+
+    if (!IsEqual(parts[0], "HOTP"))
+        return 0x04;
+
+    if (IsEqual(parts[1], "SHA1"))
+        suite.hmac = OcraHmac::HOTP_SHA1;
+    else if (IsEqual(parts[1], "SHA256"))
+        suite.hmac = OcraHmac::HOTP_SHA256;
+    else if (IsEqual(parts[1], "SHA512"))
+        suite.hmac = OcraHmac::HOTP_SHA512;
+    else
+        return 0x05;
+
+    const auto& digits = parts[2];
+    if (digits == "0" || (digits.size() == 1u && digits[0] >= '4' && digits[0] <= '9'))
+        suite.digits = static_cast<OcraDigits>(digits[0] - '0');
+    else if (digits == "10")
+        suite.digits = OcraDigits::_10;
+    else
+        return 0x06;
+    return 0;
+}
+
+constexpr int ParseChallenge(std::string_view challenge, OcraSuite& suite)
+{
+    challenge.remove_prefix(1);
+    if (challenge.size() != 3u)
+        return 0x07;
+
+    const auto format = suite.challenge.format = ToUpper(challenge[0]);
+    if (format != 'A' && format != 'N' && format != 'H')
+        return 0x08;
+
+    suite.challenge.length = static_cast<uint8_t>(ToInt(challenge.substr(1)));
+    if (suite.challenge.length < 4u || suite.challenge.length > 64u)
+        return 0x09;
+    return 0;
+}
+
+constexpr int ParsePassword(std::string_view password, OcraSuite& suite)
+{
+    password.remove_prefix(1);
+    if (IsEqual(password, "SHA1"))
+        suite.passwordSha = OcraSha::SHA1;
+    else if (IsEqual(password, "SHA256"))
+        suite.passwordSha = OcraSha::SHA256;
+    else if (IsEqual(password, "SHA512"))
+        suite.passwordSha = OcraSha::SHA512;
+    else
+        return 0x0A;
+    return 0;
+}
+
+constexpr int ParseSession(std::string_view session, OcraSuite& suite)
+{
+    session.remove_prefix(1);
+    if (session.size() != 3u)
+        return 0x0B;
+
+    suite.sessionLength = static_cast<uint16_t>(ToInt(session));
+    if (suite.sessionLength < 1u || suite.sessionLength > 512u)
+        return 0x0C;
+    return 0;
+}
+
+// Hours are not limited, as in the runtime validation
+constexpr int ParseTimestamp(std::string_view timestamp, OcraSuite& suite)
+{
+    timestamp.remove_prefix(1);
+    if (timestamp.size() < 2u || timestamp.size() > 3u)
+        return 0x0D;
+
+    const auto step = suite.timestamp.step = ToUpper(timestamp.back());
+    if (step != 'S' && step != 'M' && step != 'H')
+        return 0x0E;
+
+    timestamp.remove_suffix(1);
+    suite.timestamp.time = static_cast<uint8_t>(ToInt(timestamp));
+    if ((step == 'S' || step == 'M') && (suite.timestamp.time < 1u || suite.timestamp.time > 59u))
+        return 0x0F;
+    return 0;
+}
+
+constexpr int ParseDataInput(std::string_view dataInput, OcraSuite& suite)
+{
+    std::string_view parts[5] = {};
+    const auto size = Split(dataInput, '-', parts);
+    auto input = std::size_t{};
+
+    if (parts[input].empty())
+        return 0x1B;
+    if (ToUpper(parts[input][0]) == 'C')
+    {
+        suite.isCounter = true;
+        ++input;
+    }
+
+    if (parts[input].empty())
+        return 0x1C;
+    if (ToUpper(parts[input][0]) != 'Q')
+        return 0x1D;
+    if (const auto status = ParseChallenge(parts[input++], suite))
+        return status;
+
+    if (!parts[input].empty() && ToUpper(parts[input][0]) == 'P')
+    {
+        if (const auto status = ParsePassword(parts[input++], suite))
+            return status;
+    }
+
+    if (!parts[input].empty() && ToUpper(parts[input][0]) == 'S')
+    {
+        if (const auto status = ParseSession(parts[input++], suite))
+            return status;
+    }
+
+    if (!parts[input].empty() && ToUpper(parts[input][0]) == 'T')
+    {
+        if (const auto status = ParseTimestamp(parts[input++], suite))
+            return status;
+    }
+
+    if (input != size)
+        return 0x1E;
+    return 0;
+}
+}  // namespace parser
+
+
+// The suite grammar of RFC6287, case insensitive, usable at compile time. Gives the same
+// failure codes as the Ocra validation, 'suite' holds the parts parsed before the failure
+constexpr SuiteParseResult ParseSuite(std::string_view suite)
+{
+    auto result = SuiteParseResult{};
+    suite = suite.substr(0, suite.find('\0'));
+
+    std::string_view parts[3] = {};
+    if (parser::Split(suite, ':', parts) != 3u)
+    {
+        result.status = 0x01;
+        return result;
+    }
+
+    if (!parser::IsEqual(parts[0], "OCRA-1"))
+    {
+        result.status = 0x02;
+        return result;
+    }
+    result.suite.version = OcraVersion::OCRA_1;
+
+    result.status = parser::ParseCryptoFunction(parts[1], result.suite);
+    if (!result.status)
+        result.status = parser::ParseDataInput(parts[2], result.suite);
+    return result;
+}
+}  // namespace ocra
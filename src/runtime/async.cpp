@@ -0,0 +1,222 @@
+#include "async.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "ocra/message.hpp"
+#include "ocra/provider.hpp"
+
+
+namespace ocra::runtime
+{
+// State of one call with an asynchronous provider, shared by its steps
+struct AsyncOcra::Operation
+{
+public:
+    // Candidates of Verify in flight at once, as a chunk of the batch Verify
+    static constexpr std::size_t CHUNK = 64u;
+
+    OcraParametersView parameters;
+    std::string_view response;
+    uint64_t count{1u};
+    uint64_t first{};
+    std::size_t lanes{};
+    std::atomic<std::size_t> pending{};
+    std::atomic<bool> isFailed{};
+    std::vector<uint8_t> messages;
+    uint8_t digests[CHUNK][hash::MAX_DIGEST_SIZE];
+    OtpResult otp;
+    VerifyResult verify;
+    ComputeDone computeDone;
+    VerifyDone verifyDone;
+};
+
+
+AsyncOcra::AsyncOcra(Ocra ocra, Executor& executor, const AsyncHashProvider* provider)
+    : m_ocra{std::move(ocra)}
+    , m_executor{executor}
+    , m_provider{provider}
+{}
+
+void AsyncOcra::ComputeAsync(const OcraParametersView& parameters, ComputeDone done) const
+{
+    if (!m_provider)
+    {
+        m_executor.Post([this, parameters, done = std::move(done)]() { done(m_ocra.TryCompute(parameters)); });
+        return;
+    }
+
+    auto operation = std::make_shared<Operation>();
+    operation->parameters = parameters;
+    operation->computeDone = std::move(done);
+    m_executor.Post([this, operation]() { Start(operation); });
+}
+
+void AsyncOcra::VerifyAsync(const OcraParametersView& parameters, std::string_view response, uint64_t window,
+                            VerifyDone done) const
+{
+    if (!m_provider)
+    {
+        m_executor.Post([this, parameters, response, window, done = std::move(done)]()
+        {
+            auto result = VerifyResult{};
+            if (m_ocra.Suite().isCounter)
+                result = m_ocra.TryVerify(parameters, response, window);
+            else if (const auto status = Check(parameters, window))
+                result.status = status;
+            else
+            {
+                const auto otp = m_ocra.TryCompute(parameters);
+                result.status = otp.status;
+                result.isMatch = !otp.status && IsEqualConstantTime(otp.View(), response);
+            }
+            done(result);
+        });
+        return;
+    }
+
+    auto operation = std::make_shared<Operation>();
+    operation->parameters = parameters;
+    operation->response = response;
+    operation->verifyDone = std::move(done);
+    if (m_ocra.Suite().isCounter)
+        operation->count = std::min(window, Ocra::MAX_WINDOW) + 1u;
+
+    if (const auto status = Check(parameters, window))
+        m_executor.Post([this, operation, status]() { Complete(*operation, status); });
+    else
+        m_executor.Post([this, operation]() { Start(operation); });
+}
+
+// The failures of Verify found before the inputs
+int AsyncOcra::Check(const OcraParametersView& parameters, uint64_t window) const
+{
+    if (!m_ocra.Plan().assemble)
+        return 0x01;
+    if (!m_ocra.Suite().isCounter && window)
+        return 0x21;
+    if (m_ocra.Suite().isCounter && !parameters.counter)
+        return 0x12;
+    if (m_ocra.Suite().isCounter && std::min(window, Ocra::MAX_WINDOW) > UINT64_MAX - *parameters.counter)
+        return 0x28;
+    return 0;
+}
+
+void AsyncOcra::Start(const std::shared_ptr<Operation>& operation) const
+{
+    const auto& plan = m_ocra.Plan();
+    auto status = !plan.assemble ? 0x01 : (operation->parameters.key.empty() ? 0x10 : 0);
+    if (!status)
+    {
+        // Every candidate of a chunk has its own copy of the message
+        const auto size = std::size_t{plan.prefixLength} + plan.length;
+        const auto lanes = static_cast<std::size_t>(std::min<uint64_t>(operation->count, Operation::CHUNK));
+        auto& messages = operation->messages;
+        messages.resize(lanes * size);
+        memcpy(messages.data(), m_ocra.m_suiteStr.c_str(), plan.prefixLength);
+        status = plan.assemble(plan, messages.data() + plan.prefixLength, operation->parameters, ProviderPasswordHash);
+        for (auto l = 1u; !status && l < lanes; ++l)
+            memcpy(messages.data() + l * size, messages.data(), size);
+    }
+
+    if (status)
+        Complete(*operation, status);
+    else
+        Hash(operation);
+}
+
+// All candidates of a chunk go to the provider at once, the last one to complete posts the
+// check of the chunk to the executor
+void AsyncOcra::Hash(const std::shared_ptr<Operation>& operation) const
+{
+    const auto& plan = m_ocra.Plan();
+    const auto size = std::size_t{plan.prefixLength} + plan.length;
+    const auto lanes = static_cast<std::size_t>(std::min<uint64_t>(operation->count - operation->first,
+                                                                    Operation::CHUNK));
+    if (operation->verifyDone && m_ocra.Suite().isCounter)
+    {
+        for (auto l = 0u; l < lanes; ++l)
+            StoreBE64(operation->messages.data() + l * size + plan.prefixLength + plan.counterOffset,
+                      *operation->parameters.counter + operation->first + l);
+    }
+
+    operation->lanes = lanes;
+    operation->isFailed.store(false, std::memory_order_relaxed);
+    operation->pending.store(lanes, std::memory_order_relaxed);
+
+    const auto hmac = m_ocra.Suite().hmac;
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(hmac));
+    for (auto l = 0u; l < lanes; ++l)
+    {
+        m_provider->Hmac(hmac, operation->parameters.key, {operation->messages.data() + l * size, size},
+                         {operation->digests[l], digestSize},
+            [this, operation](bool isHashed)
+            {
+                if (!isHashed)
+                    operation->isFailed.store(true, std::memory_order_relaxed);
+                if (operation->pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+                    m_executor.Post([this, operation]() { Finish(operation); });
+            });
+    }
+}
+
+// A failed candidate fails the chunk with 0x11, as a failed batch call of Verify
+void AsyncOcra::Finish(const std::shared_ptr<Operation>& operation) const
+{
+    if (operation->isFailed.load(std::memory_order_relaxed))
+    {
+        Complete(*operation, 0x11);
+        return;
+    }
+
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(m_ocra.Suite().hmac));
+    if (!operation->verifyDone)
+    {
+        m_ocra.Truncate(operation->digests[0], digestSize, operation->otp);
+        Complete(*operation, 0);
+        return;
+    }
+
+    auto isMatch = false;
+    auto match = uint64_t{};
+    for (auto l = operation->lanes; l--;)
+    {
+        auto otp = OtpResult{};
+        m_ocra.Truncate(operation->digests[l], digestSize, otp);
+        const auto isEqual = IsEqualConstantTime(otp.View(), operation->response);
+        match = isEqual ? l : match;
+        isMatch |= isEqual;
+    }
+
+    if (isMatch)
+    {
+        operation->verify.isMatch = true;
+        operation->verify.offset = operation->first + match;
+        Complete(*operation, 0);
+    }
+    else if ((operation->first += operation->lanes) < operation->count)
+        Hash(operation);
+    else
+        Complete(*operation, 0);
+}
+
+void AsyncOcra::Complete(Operation& operation, int status) const
+{
+    if (operation.verifyDone)
+    {
+        operation.verify.status = status;
+        operation.verifyDone(operation.verify);
+        return;
+    }
+
+    if (status)
+    {
+        operation.otp = OtpResult{};
+        operation.otp.status = status;
+    }
+    operation.computeDone(operation.otp);
+}
+
+}  // namespace ocra::runtime
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <inttypes.h>
+#include <memory>
+#include <string_view>
+
+#include "ocra/ocra.hpp"
+#include "executor.hpp"
+
+
+namespace ocra::runtime
+{
+// HMAC computed outside of the calling thread, e.g. by a remote signer holding the key ('key'
+// may be its handle). 'Hmac' only starts the computation and calls 'done' from any thread once
+// 'digest' (of the digest size of 'hmac') is written, 'false' for a failure. 'message' and
+// 'digest' stay valid until then
+class AsyncHashProvider
+{
+public:
+    using Done = std::function<void(bool isHashed)>;
+
+    virtual ~AsyncHashProvider() = default;
+
+    virtual void Hmac(OcraHmac hmac, Span<const uint8_t> key, Span<const uint8_t> message,
+                      Span<uint8_t> digest, Done done) const = 0;
+};
+
+
+// Compute and Verify of a suite which return at once and call 'done' with the result on the
+// executor. The inputs of 'parameters' and 'response' must stay valid and the AsyncOcra
+// alive until then. Without a provider the whole call is one work of the executor, with an
+// asynchronous provider no thread of the executor waits for the HMAC and the candidates of
+// Verify are started in chunks of 64 at once. The results are the ones of TryCompute and of
+// TryVerify with the counter 'window', a suite without a counter checks only the given inputs
+// ('window' must be 0). Callback based, so that a C++20 coroutine awaits it by resuming
+// itself in 'done'
+class AsyncOcra
+{
+public:
+    using ComputeDone = std::function<void(const OtpResult& result)>;
+    using VerifyDone = std::function<void(const VerifyResult& result)>;
+
+    AsyncOcra(Ocra ocra, Executor& executor, const AsyncHashProvider* provider = nullptr);
+
+    inline const Ocra& Suite() const { return m_ocra; }
+
+    void ComputeAsync(const OcraParametersView& parameters, ComputeDone done) const;
+    void VerifyAsync(const OcraParametersView& parameters, std::string_view response, uint64_t window,
+                     VerifyDone done) const;
+
+private:
+    struct Operation;
+
+    void Start(const std::shared_ptr<Operation>& operation) const;
+    void Hash(const std::shared_ptr<Operation>& operation) const;
+    void Finish(const std::shared_ptr<Operation>& operation) const;
+    void Complete(Operation& operation, int status) const;
+    int Check(const OcraParametersView& parameters, uint64_t window) const;
+
+private:
+    const Ocra m_ocra;
+    Executor& m_executor;
+    const AsyncHashProvider* m_provider;
+};
+
+}  // namespace ocra::runtime
@@ -0,0 +1,57 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <memory>
+
+
+namespace ocra::runtime
+{
+namespace
+{
+// Computed codes of one worker, on its own cache line
+struct alignas(64) Counter
+{
+    std::size_t value{};
+};
+}  // namespace
+
+
+BatchEvaluator::BatchEvaluator(ThreadPool& pool, std::size_t grain)
+    : m_pool{pool}
+    , m_grain{std::max<std::size_t>((grain + hash::MAX_LANES - 1u) / hash::MAX_LANES, 1u) * hash::MAX_LANES}
+{}
+
+std::size_t BatchEvaluator::Compute(const Ocra& ocra, Span<const OcraParametersView> parameters,
+                                    Span<OtpResult> results) const
+{
+    return Run(ocra, parameters, results);
+}
+
+std::size_t BatchEvaluator::Compute(const Ocra& ocra, Span<const OcraParameters> parameters,
+                                    Span<OtpResult> results) const
+{
+    return Run(ocra, parameters, results);
+}
+
+template <typename Parameters>
+std::size_t BatchEvaluator::Run(const Ocra& ocra, Span<const Parameters> parameters, Span<OtpResult> results) const
+{
+    // An invalid suite, a short 'results' or a batch of one chunk is left to Ocra::Compute
+    if (!ocra.Plan().assemble || results.size() < parameters.size() ||
+        parameters.size() <= m_grain || m_pool.Workers() == 1u)
+        return ocra.Compute(parameters, results);
+
+    const auto counters = std::make_unique<Counter[]>(m_pool.Workers());
+    m_pool.ParallelFor(parameters.size(), m_grain,
+        [&](std::size_t begin, std::size_t end, std::size_t worker) {
+            counters[worker].value += ocra.Compute(parameters.subspan(begin, end - begin),
+                                                   results.subspan(begin, end - begin));
+        });
+
+    auto computed = std::size_t{};
+    for (auto i = 0u; i < m_pool.Workers(); ++i)
+        computed += counters[i].value;
+    return computed;
+}
+
+}  // namespace ocra::runtime
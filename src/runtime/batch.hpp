@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ocra/ocra.hpp"
+#include "threadpool.hpp"
+
+
+namespace ocra::runtime
+{
+// Batch Compute of Ocra spread over the workers of a pool. Each worker hashes chunks of
+// 'grain' requests with the multi-buffer kernels, the results are the ones of
+// Ocra::Compute, also the failures of single requests and of the whole batch
+class BatchEvaluator
+{
+public:
+    // Default chunk, a multiple of the lane count short enough to be stolen
+    static constexpr std::size_t GRAIN = 16u * hash::MAX_LANES;
+
+    explicit BatchEvaluator(ThreadPool& pool, std::size_t grain = GRAIN);
+
+    std::size_t Compute(const Ocra& ocra, Span<const OcraParametersView> parameters, Span<OtpResult> results) const;
+    std::size_t Compute(const Ocra& ocra, Span<const OcraParameters> parameters, Span<OtpResult> results) const;
+
+private:
+    template <typename Parameters>
+    std::size_t Run(const Ocra& ocra, Span<const Parameters> parameters, Span<OtpResult> results) const;
+
+private:
+    ThreadPool& m_pool;
+    std::size_t m_grain;
+};
+
+}  // namespace ocra::runtime
@@ -0,0 +1,53 @@
+#include "executor.hpp"
+
+#include <algorithm>
+
+
+namespace ocra::runtime
+{
+ThreadExecutor::ThreadExecutor(std::size_t threads)
+{
+    threads = std::max<std::size_t>(threads, 1u);
+    m_threads.reserve(threads);
+    for (auto i = 0u; i < threads; ++i)
+        m_threads.emplace_back([this]() { Run(); });
+}
+
+ThreadExecutor::~ThreadExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadExecutor::Post(std::function<void()> work)
+{
+    // Notified under the lock, the work may end the life of the executor as soon as it runs,
+    // the destructor takes the lock only after this call is done with the condition
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_works.push_back(std::move(work));
+    m_wake.notify_one();
+}
+
+void ThreadExecutor::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_wake.wait(lock, [this]() { return m_isStopping || !m_works.empty(); });
+        if (m_works.empty())
+            return;
+
+        auto work = std::move(m_works.front());
+        m_works.pop_front();
+        lock.unlock();
+        work();
+        lock.lock();
+    }
+}
+
+}  // namespace ocra::runtime
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace ocra::runtime
+{
+// Runs the steps of the asynchronous calls, e.g. the thread pool or the event loop of a
+// service. 'Post' may be called from any thread, also from a running work
+class Executor
+{
+public:
+    virtual ~Executor() = default;
+
+    virtual void Post(std::function<void()> work) = 0;
+};
+
+
+// Executor of own threads taking the works in their order
+class ThreadExecutor : public Executor
+{
+public:
+    explicit ThreadExecutor(std::size_t threads = 1u);
+    // Runs the works posted before, 'Post' must not be called any more
+    ~ThreadExecutor() override;
+    ThreadExecutor(const ThreadExecutor&) = delete;
+    ThreadExecutor& operator=(const ThreadExecutor&) = delete;
+
+    void Post(std::function<void()> work) override;
+
+private:
+    void Run();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_works;
+    bool m_isStopping{};
+    std::vector<std::thread> m_threads;
+};
+
+}  // namespace ocra::runtime
@@ -0,0 +1,275 @@
+#include "pipeline.hpp"
+
+#include <cstring>
+
+#include "ocra/message.hpp"
+#include "ocra/provider.hpp"
+
+
+namespace ocra::runtime
+{
+namespace
+{
+using Queue = BoundedQueue<PipelineRequest*>;
+
+// An idle stage gives the processor away a few times and then sleeps until it is woken
+template <typename Ready>
+void Backoff(unsigned& idle, Waiters& waiters, const Ready& isReady)
+{
+    constexpr auto YIELDS = 64u;
+    if (++idle < YIELDS)
+        std::this_thread::yield();
+    else
+        waiters.Wait(isReady);
+}
+}  // namespace
+
+
+Pipeline::Pipeline(Ocra ocra, std::size_t capacity)
+    : m_ocra{std::move(ocra)}
+    , m_isLanes{m_ocra.Plan().prefixLength <= PipelineRequest::PREFIX_LENGTH}
+    , m_queues{Queue(capacity), Queue(capacity), Queue(capacity), Queue(capacity)}
+{
+    for (auto i = 0u; i < STAGE_COUNT; ++i)
+        m_threads[i] = std::thread([this, i]() { Run(i); });
+}
+
+Pipeline::~Pipeline()
+{
+    // Every stage drains its queue and finishes after the one before it
+    m_isFinished[0].store(true, std::memory_order_release);
+    m_requests[0].Notify();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+bool Pipeline::TrySubmit(PipelineRequest& request)
+{
+    request.result = OtpResult{};
+    request.m_isDone.store(false, std::memory_order_relaxed);
+    if (!m_queues[VALIDATE].TryPush(&request))
+    {
+        m_refused.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+    m_requests[VALIDATE].Notify();
+    m_submitted.fetch_add(1u, std::memory_order_relaxed);
+    return true;
+}
+
+PipelineStatistics Pipeline::Statistics() const
+{
+    auto result = PipelineStatistics{};
+    result.submitted = m_submitted.load(std::memory_order_relaxed);
+    result.refused = m_refused.load(std::memory_order_relaxed);
+    result.failed = m_failed.load(std::memory_order_relaxed);
+    result.hashed = m_hashed.load(std::memory_order_relaxed);
+    result.batches = m_batches.load(std::memory_order_relaxed);
+    return result;
+}
+
+void Pipeline::Run(std::size_t stage)
+{
+    auto& input = m_queues[stage];
+    const auto limit = stage == HASH || stage == TRUNCATE ? hash::MAX_LANES : 1u;
+    PipelineRequest* requests[hash::MAX_LANES];
+    auto idle = 0u;
+    while (true)
+    {
+        // Read before the queue, all the requests of a finished stage are in it by then
+        const auto isLast = m_isFinished[stage].load(std::memory_order_acquire);
+        auto count = 0u;
+        while (count < limit && input.TryPop(requests[count]))
+            ++count;
+
+        if (!count)
+        {
+            if (isLast)
+                break;
+            Backoff(idle, m_requests[stage], [&]() {
+                return input.Size() || m_isFinished[stage].load(std::memory_order_acquire);
+            });
+            continue;
+        }
+
+        idle = 0u;
+        m_room[stage].Notify();
+        if (stage == VALIDATE)
+            Validate(*requests[0]);
+        else if (stage == ASSEMBLE)
+            Assemble(*requests[0]);
+        else if (stage == HASH)
+            Hash(requests, count);
+        else
+            Truncate(requests, count);
+    }
+    m_isFinished[stage + 1u].store(true, std::memory_order_release);
+    if (stage + 1u < STAGE_COUNT)
+        m_requests[stage + 1u].Notify();
+}
+
+void Pipeline::Validate(PipelineRequest& request)
+{
+    const auto& plan = m_ocra.Plan();
+    const auto status = request.parameters.key.empty() ? 0x10 :
+                        !plan.check ? 0x01 : plan.check(plan, request.parameters);
+    if (status)
+        Complete(request, status);
+    else
+        Forward(ASSEMBLE, request);
+}
+
+void Pipeline::Assemble(PipelineRequest& request)
+{
+    const auto& plan = m_ocra.Plan();
+    auto* message = request.m_message;
+    if (m_isLanes)
+    {
+        memcpy(message, m_ocra.m_suiteStr.c_str(), plan.prefixLength);
+        message += plan.prefixLength;
+    }
+
+    const auto passwordHash = IsBuiltinHmac(m_ocra.Suite().hmac) ? RegisteredPasswordHash : ProviderPasswordHash;
+    if (const auto status = plan.write(plan, message, request.parameters, passwordHash))
+        Complete(request, status);
+    else
+        Forward(HASH, request);
+}
+
+void Pipeline::Hash(PipelineRequest* const* requests, std::size_t count)
+{
+    const auto& plan = m_ocra.Plan();
+    const auto algorithm = static_cast<hash::Algorithm>(m_ocra.Suite().hmac);
+    if (!IsBuiltinHmac(m_ocra.Suite().hmac))
+    {
+        HashWithProvider(requests, count);
+        return;
+    }
+
+    if (m_isLanes)
+    {
+        const uint8_t* keys[hash::MAX_LANES] = {};
+        std::size_t keySizes[hash::MAX_LANES] = {};
+        const uint8_t* messages[hash::MAX_LANES] = {};
+        uint8_t* digests[hash::MAX_LANES] = {};
+        for (auto i = 0u; i < count; ++i)
+        {
+            keys[i] = requests[i]->parameters.key.data();
+            keySizes[i] = requests[i]->parameters.key.size();
+            messages[i] = requests[i]->m_message;
+            digests[i] = requests[i]->m_digest;
+        }
+        hash::HmacLanes(algorithm, count, keys, keySizes, messages, plan.prefixLength + plan.length, digests);
+    }
+    else
+    {
+        // A suite longer than the lane buffers is hashed one request at a time
+        for (auto i = 0u; i < count; ++i)
+        {
+            auto& request = *requests[i];
+            auto context = hash::HmacContext(algorithm, request.parameters.key.data(), request.parameters.key.size());
+            context.Update(reinterpret_cast<const uint8_t*>(m_ocra.m_suiteStr.c_str()), plan.prefixLength);
+            context.Update(request.m_message, plan.length);
+            context.Final(request.m_digest);
+        }
+    }
+
+    m_hashed.fetch_add(count, std::memory_order_relaxed);
+    m_batches.fetch_add(1u, std::memory_order_relaxed);
+    for (auto i = 0u; i < count; ++i)
+        Forward(TRUNCATE, *requests[i]);
+}
+
+// The keys of a registered provider or batch function are not for the built-in engine, the
+// requests go to the provider as in the batch operator(), a failed call fails all of them with 0x11
+void Pipeline::HashWithProvider(PipelineRequest* const* requests, std::size_t count)
+{
+    const auto& plan = m_ocra.Plan();
+    const auto& provider = Provider(m_ocra.Suite().hmac);
+    const auto digestSize = hash::DigestSize(static_cast<hash::Algorithm>(m_ocra.Suite().hmac));
+    bool isHashed[hash::MAX_LANES] = {};
+    if (m_isLanes)
+    {
+        Span<const uint8_t> keys[hash::MAX_LANES];
+        Span<const uint8_t> messages[hash::MAX_LANES];
+        Span<uint8_t> digests[hash::MAX_LANES];
+        for (auto i = 0u; i < count; ++i)
+        {
+            keys[i] = requests[i]->parameters.key;
+            messages[i] = {requests[i]->m_message, std::size_t{plan.prefixLength} + plan.length};
+            digests[i] = {requests[i]->m_digest, digestSize};
+        }
+        const auto isBatchHashed = provider.Batch(count, keys, messages, digests);
+        for (auto i = 0u; i < count; ++i)
+            isHashed[i] = isBatchHashed;
+    }
+    else
+    {
+        // The message has no room for the suite prefix, it is streamed as a piece of its own
+        for (auto i = 0u; i < count; ++i)
+        {
+            auto& request = *requests[i];
+            HashProvider::State state;
+            const auto isInit = provider.Init(state, request.parameters.key);
+            if (isInit)
+            {
+                provider.Update(state, {reinterpret_cast<const uint8_t*>(m_ocra.m_suiteStr.c_str()),
+                                        plan.prefixLength});
+                provider.Update(state, {request.m_message, plan.length});
+            }
+            isHashed[i] = provider.Final(state, {request.m_digest, digestSize}) && isInit;
+        }
+    }
+
+    m_hashed.fetch_add(count, std::memory_order_relaxed);
+    m_batches.fetch_add(1u, std::memory_order_relaxed);
+    for (auto i = 0u; i < count; ++i)
+    {
+        if (isHashed[i])
+            Forward(TRUNCATE, *requests[i]);
+        else
+            Complete(*requests[i], 0x11);
+    }
+}
+
+void Pipeline::Truncate(PipelineRequest* const* requests, std::size_t count)
+{
+    const uint8_t* digests[hash::MAX_LANES] = {};
+    OtpResult* results[hash::MAX_LANES] = {};
+    for (auto i = 0u; i < count; ++i)
+    {
+        digests[i] = requests[i]->m_digest;
+        results[i] = &requests[i]->result;
+    }
+    m_ocra.TruncateLanes(digests, count, hash::DigestSize(static_cast<hash::Algorithm>(m_ocra.Suite().hmac)),
+                         results);
+
+    for (auto i = 0u; i < count; ++i)
+        Complete(*requests[i], 0);
+}
+
+// Waits for room in the queue of the next stage, the backpressure of the pipeline
+void Pipeline::Forward(std::size_t stage, PipelineRequest& request)
+{
+    auto& queue = m_queues[stage];
+    auto idle = 0u;
+    while (!queue.TryPush(&request))
+        Backoff(idle, m_room[stage], [&]() { return queue.Size() < queue.Capacity(); });
+    m_requests[stage].Notify();
+}
+
+void Pipeline::Complete(PipelineRequest& request, int status)
+{
+    if (status)
+    {
+        request.result.status = status;
+        m_failed.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    if (request.done)
+        request.done(request);
+    else
+        request.m_isDone.store(true, std::memory_order_release);
+}
+
+}  // namespace ocra::runtime
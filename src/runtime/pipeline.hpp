@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <inttypes.h>
+#include <thread>
+
+#include "ocra/ocra.hpp"
+#include "queue.hpp"
+
+
+namespace ocra::runtime
+{
+// One request of the pipeline, owned by the caller and left untouched until it is done.
+// The pipeline either calls 'done' or, without it, sets IsDone, and does not use the
+// request any more afterwards
+class PipelineRequest
+{
+public:
+    using Done = void (*)(PipelineRequest& request);
+
+    inline bool IsDone() const { return m_isDone.load(std::memory_order_acquire); }
+
+public:
+    OcraParametersView parameters;
+    OtpResult result;
+    Done done{};
+    void* context{};
+
+private:
+    friend class Pipeline;
+
+    // Suite prefix of up to PREFIX_LENGTH bytes followed by the variable part
+    static constexpr std::size_t PREFIX_LENGTH = 128u;
+
+    std::atomic<bool> m_isDone{};
+    uint8_t m_message[PREFIX_LENGTH + EvaluationPlan::MAX_LENGTH];
+    uint8_t m_digest[hash::MAX_DIGEST_SIZE];
+};
+
+
+// Totals since the start of the pipeline, 'batches' are the calls of the hash stage
+struct PipelineStatistics
+{
+public:
+    uint64_t submitted{};
+    uint64_t refused{};
+    uint64_t failed{};
+    uint64_t hashed{};
+    uint64_t batches{};
+};
+
+
+// The batch Compute of one suite split into stages on own threads: the input checks, the
+// message assembly, the HMAC and the truncation. The stages are joined by bounded queues,
+// so the hash stage gathers the requests of many producers into the multi-buffer lanes.
+// A stage waits for room in a full queue, which fills the queues before it up to the first
+// one and TrySubmit refuses the requests then. The codes are the ones of Ocra::Compute
+class Pipeline
+{
+public:
+    // Bound of each queue, rounded up to a power of two
+    static constexpr std::size_t CAPACITY = 1024u;
+
+    explicit Pipeline(Ocra ocra, std::size_t capacity = CAPACITY);
+    // Finishes every submitted request, TrySubmit must not be called any more
+    ~Pipeline();
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    inline const Ocra& Suite() const { return m_ocra; }
+
+    // False when the first queue is full, 'request' is not taken then
+    bool TrySubmit(PipelineRequest& request);
+
+    PipelineStatistics Statistics() const;
+
+private:
+    enum StageIndex : std::size_t
+    {
+        VALIDATE,
+        ASSEMBLE,
+        HASH,
+        TRUNCATE,
+        STAGE_COUNT
+    };
+
+    void Run(std::size_t stage);
+    void Validate(PipelineRequest& request);
+    void Assemble(PipelineRequest& request);
+    void Hash(PipelineRequest* const* requests, std::size_t count);
+    void HashWithProvider(PipelineRequest* const* requests, std::size_t count);
+    void Truncate(PipelineRequest* const* requests, std::size_t count);
+    void Forward(std::size_t stage, PipelineRequest& request);
+    void Complete(PipelineRequest& request, int status);
+
+private:
+    const Ocra m_ocra;
+    const bool m_isLanes;
+    BoundedQueue<PipelineRequest*> m_queues[STAGE_COUNT];
+    // Stages waiting for a request in their queue and for room in the queue of the next one
+    Waiters m_requests[STAGE_COUNT];
+    Waiters m_room[STAGE_COUNT];
+    std::atomic<bool> m_isFinished[STAGE_COUNT + 1u] = {};
+    std::thread m_threads[STAGE_COUNT];
+
+    std::atomic<uint64_t> m_submitted{};
+    std::atomic<uint64_t> m_refused{};
+    std::atomic<uint64_t> m_failed{};
+    std::atomic<uint64_t> m_hashed{};
+    std::atomic<uint64_t> m_batches{};
+};
+
+}  // namespace ocra::runtime
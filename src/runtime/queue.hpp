@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+
+namespace ocra::runtime
+{
+// Bounded multi-producer multi-consumer queue without locks. Every cell has a sequence number
+// telling whether it waits for a value of the current lap or for its consumer, so a producer
+// and a consumer meet only on the cell they use. A full queue refuses the value, the bound
+// is the backpressure of the stage writing to it
+template <typename T>
+class BoundedQueue
+{
+public:
+    // 'capacity' is rounded up to a power of two, at least 2
+    explicit BoundedQueue(std::size_t capacity)
+    {
+        auto size = std::size_t{2u};
+        while (size < capacity)
+            size *= 2u;
+        m_mask = size - 1u;
+        m_cells.reset(new Cell[size]);
+        for (auto i = std::size_t{}; i < size; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    inline std::size_t Capacity() const { return m_mask + 1u; }
+
+    // Approximate while other threads push or pop
+    inline std::size_t Size() const
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0u;
+    }
+
+    // False when the queue is full, 'value' is not taken then
+    bool TryPush(const T& value)
+    {
+        auto position = m_head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = m_cells[position & m_mask];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (m_head.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1u, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (sequence < position)
+                return false;
+            else
+                position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // False when the queue is empty
+    bool TryPop(T& value)
+    {
+        auto position = m_tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = m_cells[position & m_mask];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position + 1u)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+                {
+                    value = cell.value;
+                    cell.sequence.store(position + m_mask + 1u, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (sequence < position + 1u)
+                return false;
+            else
+                position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask{};
+    alignas(64) std::atomic<std::size_t> m_head{};
+    alignas(64) std::atomic<std::size_t> m_tail{};
+};
+
+
+// Sleep of the threads waiting for a state of the queues, e.g. a value or room in one. A waiter
+// registers before its last check of 'isReady', so a thread which changes the state and calls
+// Notify afterwards is either seen by that check or wakes it. Notify without waiters is only
+// a fence and a load, the busy path does not take the lock
+class Waiters
+{
+public:
+    template <typename Ready>
+    void Wait(const Ready& isReady)
+    {
+        m_count.fetch_add(1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, isReady);
+        }
+        m_count.fetch_sub(1u, std::memory_order_relaxed);
+    }
+
+    void Notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_count.load(std::memory_order_relaxed))
+            return;
+        {
+            // A waiter between its check and the sleep holds the lock, it cannot miss the wake
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_wake.notify_all();
+    }
+
+private:
+    std::atomic<unsigned> m_count{};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+};
+
+}  // namespace ocra::runtime
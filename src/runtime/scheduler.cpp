@@ -0,0 +1,225 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+
+#include "ocra/message.hpp"
+
+
+namespace ocra::runtime
+{
+namespace
+{
+std::size_t Bucket(uint64_t value)
+{
+    auto bucket = std::size_t{};
+    while (value > 1u && bucket + 1u < SchedulerStatistics::BUCKETS)
+    {
+        value >>= 1u;
+        ++bucket;
+    }
+    return bucket;
+}
+}  // namespace
+
+
+uint64_t SchedulerStatistics::Quantile(const uint64_t (&histogram)[BUCKETS], double q)
+{
+    auto total = uint64_t{};
+    for (const auto count : histogram)
+        total += count;
+
+    auto sum = uint64_t{};
+    for (auto i = 0u; i < BUCKETS; ++i)
+    {
+        sum += histogram[i];
+        if (sum && sum >= q * total)
+            return uint64_t{2u} << i;
+    }
+    return 0u;
+}
+
+
+BatchScheduler::BatchScheduler(Ocra ocra, SchedulerOptions options)
+    : m_ocra{std::move(ocra)}
+    , m_options{options}
+{
+    m_options.maxBatch = std::max<std::size_t>(m_options.maxBatch, 1u);
+    m_thread = std::thread([this]() { Run(); });
+}
+
+BatchScheduler::~BatchScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void BatchScheduler::Submit(VerifyRequest& request)
+{
+    request.result = VerifyResult{};
+    request.m_isDone.store(false, std::memory_order_relaxed);
+    request.m_submitted = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.push_back(&request);
+    m_candidates += Candidates(request);
+    ++m_statistics.requests;
+
+    // The thread waits for the deadline of the first request or for a full batch
+    const auto isWake = m_pending.size() == 1u || Reason(request.m_submitted) != Flush::None;
+    lock.unlock();
+    if (isWake)
+        m_wake.notify_one();
+}
+
+SchedulerStatistics BatchScheduler::Statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+// A request with more candidates than a batch is verified on its own, it fills a batch
+std::size_t BatchScheduler::Candidates(const VerifyRequest& request) const
+{
+    if (!m_ocra.Suite().isCounter || !request.parameters.counter)
+        return 1u;
+    const auto window = std::min(request.window, Ocra::MAX_WINDOW);
+    if (window >= m_options.maxBatch || window > UINT64_MAX - *request.parameters.counter)
+        return m_options.maxBatch + 1u;
+    return window + 1u;
+}
+
+BatchScheduler::Flush BatchScheduler::Reason(std::chrono::steady_clock::time_point now) const
+{
+    if (m_pending.empty())
+        return Flush::None;
+    if (m_candidates >= m_options.maxBatch)
+        return Flush::Batch;
+    if (m_options.isLaneFlush && m_candidates >= hash::Lanes(static_cast<hash::Algorithm>(m_ocra.Suite().hmac)))
+        return Flush::Lanes;
+    if (m_isStopping || now >= m_pending.front()->m_submitted + m_options.maxWait)
+        return Flush::Deadline;
+    return Flush::None;
+}
+
+void BatchScheduler::Run()
+{
+    auto batch = std::vector<VerifyRequest*>{};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        if (m_pending.empty())
+        {
+            if (m_isStopping)
+                break;
+            m_wake.wait(lock, [this]() { return m_isStopping || !m_pending.empty(); });
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto reason = Reason(now);
+        if (reason == Flush::None)
+        {
+            m_wake.wait_until(lock, m_pending.front()->m_submitted + m_options.maxWait);
+            continue;
+        }
+
+        // The batch takes the requests up to 'maxBatch' candidates, at least one
+        auto candidates = std::size_t{};
+        auto count = std::size_t{};
+        while (count < m_pending.size() &&
+               (!count || candidates + Candidates(*m_pending[count]) <= m_options.maxBatch))
+            candidates += Candidates(*m_pending[count++]);
+        batch.assign(m_pending.begin(), m_pending.begin() + count);
+        m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+        m_candidates -= candidates;
+
+        // Recorded first, a verified request belongs to the caller again
+        Record(batch, candidates, reason, now);
+        lock.unlock();
+        Verify(batch);
+        lock.lock();
+    }
+}
+
+void BatchScheduler::Verify(const std::vector<VerifyRequest*>& batch)
+{
+    const auto& suite = m_ocra.Suite();
+    m_views.clear();
+    for (auto* request : batch)
+    {
+        auto& result = request->result;
+        const auto candidates = Candidates(*request);
+        if (!m_ocra.Plan().assemble)
+            result.status = 0x01;
+        else if (!suite.isCounter && request->window)
+            result.status = 0x21;
+        else if (suite.isCounter && !request->parameters.counter)
+            result.status = 0x12;
+        else if (candidates > m_options.maxBatch)
+            result = m_ocra.TryVerify(request->parameters, request->response, request->window);
+        else
+        {
+            for (auto i = std::size_t{}; i < candidates; ++i)
+            {
+                m_views.push_back(request->parameters);
+                if (suite.isCounter)
+                    m_views.back().counter = *request->parameters.counter + i;
+            }
+        }
+    }
+
+    m_otps.resize(m_views.size());
+    if (!m_views.empty())
+        m_ocra.Compute(Span<const OcraParametersView>(m_views), Span<OtpResult>(m_otps));
+
+    // The candidates of a request differ only by the counter, they fail all or none
+    auto index = std::size_t{};
+    for (auto* request : batch)
+    {
+        auto& result = request->result;
+        const auto candidates = Candidates(*request);
+        if (!result.status && candidates <= m_options.maxBatch)
+        {
+            result.status = m_otps[index].status;
+            for (auto i = std::size_t{}; i < candidates && !result.status && !result.isMatch; ++i)
+            {
+                if (IsEqualConstantTime(m_otps[index + i].View(), request->response))
+                {
+                    result.isMatch = true;
+                    result.offset = i;
+                }
+            }
+            index += candidates;
+        }
+
+        if (request->done)
+            request->done(*request);
+        else
+            request->m_isDone.store(true, std::memory_order_release);
+    }
+}
+
+void BatchScheduler::Record(const std::vector<VerifyRequest*>& batch, std::size_t candidates, Flush reason,
+                            std::chrono::steady_clock::time_point start)
+{
+    auto& statistics = m_statistics;
+    ++statistics.batches;
+    statistics.laneFlushes += reason == Flush::Lanes;
+    statistics.batchFlushes += reason == Flush::Batch;
+    statistics.deadlineFlushes += reason == Flush::Deadline;
+    ++statistics.sizes[Bucket(candidates)];
+    for (const auto* request : batch)
+    {
+        const auto wait = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start - request->m_submitted).count());
+        ++statistics.waits[Bucket(wait / 1000u)];
+        statistics.waitNanoseconds += wait;
+        statistics.maxWaitNanoseconds = std::max(statistics.maxWaitNanoseconds, wait);
+    }
+}
+
+}  // namespace ocra::runtime
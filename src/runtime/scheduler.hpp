@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <inttypes.h>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ocra/ocra.hpp"
+
+
+namespace ocra::runtime
+{
+// One verification of the scheduler, owned by the caller and left untouched until it is done.
+// The result is the one of Ocra::TryVerify with the counter 'window', a suite without a counter
+// checks only the given inputs ('window' must be 0). The scheduler either calls 'done' or,
+// without it, sets IsDone, and does not use the request any more afterwards
+class VerifyRequest
+{
+public:
+    using Done = void (*)(VerifyRequest& request);
+
+    inline bool IsDone() const { return m_isDone.load(std::memory_order_acquire); }
+
+public:
+    OcraParametersView parameters;
+    std::string_view response;
+    uint64_t window{};
+    VerifyResult result;
+    Done done{};
+    void* context{};
+
+private:
+    friend class BatchScheduler;
+
+    std::atomic<bool> m_isDone{};
+    std::chrono::steady_clock::time_point m_submitted;
+};
+
+
+struct SchedulerOptions
+{
+public:
+    // Candidates (counters) of one batch, the requests above it wait for the next one
+    std::size_t maxBatch = 4u * hash::MAX_LANES;
+    // Longest time the first request of a batch waits for the others
+    std::chrono::microseconds maxWait{500};
+    // Flushes as soon as the candidates fill a group of hash lanes ('hash::Lanes' of the
+    // suite), waiting longer only makes the batch bigger, not the hashing faster
+    bool isLaneFlush = true;
+};
+
+
+// Totals since the start of the scheduler
+struct SchedulerStatistics
+{
+public:
+    static constexpr std::size_t BUCKETS = 16u;
+
+    // Upper bound of the bucket with the q-th (0..1) part of the values of 'histogram'
+    static uint64_t Quantile(const uint64_t (&histogram)[BUCKETS], double q);
+
+public:
+    uint64_t requests{};
+    uint64_t batches{};
+    // Batches by the reason of the flush
+    uint64_t laneFlushes{};
+    uint64_t batchFlushes{};
+    uint64_t deadlineFlushes{};
+    // Batches by their candidates and requests by their wait in the queue, bucket 'i' has
+    // the values of [2^i, 2^(i+1)) (candidates, microseconds), the first also the ones below
+    uint64_t sizes[BUCKETS] = {};
+    uint64_t waits[BUCKETS] = {};
+    uint64_t waitNanoseconds{};
+    uint64_t maxWaitNanoseconds{};
+};
+
+
+// Micro-batching in front of the verification of one suite. The requests are gathered by
+// a thread of the scheduler and verified together, all their candidates hashed by the
+// multi-buffer batch Compute, once the batch is full or its first request has waited
+// 'maxWait'. The size and the wait are the throughput and latency tradeoff of the suite
+class BatchScheduler
+{
+public:
+    explicit BatchScheduler(Ocra ocra, SchedulerOptions options = {});
+    // Verifies the waiting requests, Submit must not be called any more
+    ~BatchScheduler();
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+
+    inline const Ocra& Suite() const { return m_ocra; }
+
+    void Submit(VerifyRequest& request);
+
+    SchedulerStatistics Statistics() const;
+
+private:
+    enum class Flush
+    {
+        None,
+        Lanes,
+        Batch,
+        Deadline
+    };
+
+    std::size_t Candidates(const VerifyRequest& request) const;
+    Flush Reason(std::chrono::steady_clock::time_point now) const;
+    void Run();
+    void Verify(const std::vector<VerifyRequest*>& batch);
+    void Record(const std::vector<VerifyRequest*>& batch, std::size_t candidates, Flush reason,
+                std::chrono::steady_clock::time_point start);
+
+private:
+    const Ocra m_ocra;
+    SchedulerOptions m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<VerifyRequest*> m_pending;
+    std::size_t m_candidates{};
+    bool m_isStopping{};
+    SchedulerStatistics m_statistics;
+
+    // Buffers of the scheduler thread
+    std::vector<OcraParametersView> m_views;
+    std::vector<OtpResult> m_otps;
+    std::thread m_thread;
+};
+
+}  // namespace ocra::runtime
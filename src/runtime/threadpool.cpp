@@ -0,0 +1,199 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+
+
+namespace ocra::runtime
+{
+namespace
+{
+// Indices of one round of a job, the packed range keeps 32 bits for each end
+constexpr uint64_t MAX_ROUND = UINT32_MAX;
+
+inline uint64_t Pack(uint64_t begin, uint64_t end)
+{
+    return (begin << 32) | end;
+}
+
+inline uint64_t Begin(uint64_t range)
+{
+    return range >> 32;
+}
+
+inline uint64_t End(uint64_t range)
+{
+    return range & UINT32_MAX;
+}
+}  // namespace
+
+
+ThreadPool::ThreadPool(std::size_t workers)
+    : m_workers{std::max<std::size_t>(workers, 1u)}
+    , m_ranges{new Range[m_workers]}
+{
+    m_threads.reserve(m_workers - 1u);
+    for (auto i = 1u; i < m_workers; ++i)
+        m_threads.emplace_back([this, i]() { Run(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grain, const Task& task)
+{
+    std::lock_guard<std::mutex> submit(m_submit);
+    m_grain = std::max<std::size_t>(grain, 1u);
+    m_task = &task;
+    m_exception = nullptr;
+
+    for (auto offset = std::size_t{}; offset < count; offset += MAX_ROUND)
+    {
+        // Even split, the first workers get one index more
+        const auto round = std::min<uint64_t>(count - offset, MAX_ROUND);
+        auto begin = uint64_t{};
+        for (auto i = 0u; i < m_workers; ++i)
+        {
+            const auto end = begin + round / m_workers + (i < round % m_workers);
+            m_ranges[i].value.store(Pack(begin, end), std::memory_order_relaxed);
+            begin = end;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_offset = offset;
+            m_running = m_workers - 1u;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        Work(0u);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_running == 0u; });
+        if (m_exception)
+            break;
+    }
+
+    m_task = nullptr;
+    if (m_exception)
+        std::rethrow_exception(m_exception);
+}
+
+void ThreadPool::Run(std::size_t worker)
+{
+    auto generation = uint64_t{};
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_isStopping || m_generation != generation; });
+            if (m_isStopping)
+                return;
+            generation = m_generation;
+        }
+
+        Work(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_running == 0u)
+            m_done.notify_one();
+    }
+}
+
+void ThreadPool::Work(std::size_t worker)
+{
+    do
+    {
+        auto begin = uint64_t{};
+        auto end = uint64_t{};
+        while (Take(worker, begin, end))
+        {
+            try
+            {
+                (*m_task)(m_offset + begin, m_offset + end, worker);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_exception)
+                    m_exception = std::current_exception();
+            }
+        }
+    } while (Steal(worker));
+}
+
+// Only the owner moves the front of its range
+bool ThreadPool::Take(std::size_t worker, uint64_t& begin, uint64_t& end)
+{
+    auto& range = m_ranges[worker].value;
+    auto current = range.load(std::memory_order_acquire);
+    while (true)
+    {
+        begin = Begin(current);
+        const auto last = End(current);
+        if (begin >= last)
+            return false;
+
+        end = std::min<uint64_t>(begin + m_grain, last);
+        if (range.compare_exchange_weak(current, Pack(end, last), std::memory_order_acq_rel))
+            return true;
+    }
+}
+
+// Moves the back half of the largest range of the other workers into the own, empty one.
+// Ranges only shrink, so a worker finding nothing to steal has no work left to wait for
+bool ThreadPool::Steal(std::size_t worker)
+{
+    while (true)
+    {
+        auto victim = m_workers;
+        auto largest = uint64_t{};
+        for (auto i = 0u; i < m_workers; ++i)
+        {
+            const auto current = m_ranges[i].value.load(std::memory_order_relaxed);
+            const auto size = End(current) > Begin(current) ? End(current) - Begin(current) : 0u;
+            if (i != worker && size > largest)
+            {
+                largest = size;
+                victim = i;
+            }
+        }
+        if (victim == m_workers)
+            return false;
+
+        auto& range = m_ranges[victim].value;
+        auto current = range.load(std::memory_order_acquire);
+        const auto begin = Begin(current);
+        const auto end = End(current);
+        if (begin >= end)
+            continue;
+
+        // A single chunk left is not split, its owner is about to take it
+        if (end - begin <= m_grain)
+        {
+            if (range.compare_exchange_strong(current, Pack(end, end), std::memory_order_acq_rel))
+            {
+                m_ranges[worker].value.store(Pack(begin, end), std::memory_order_release);
+                return true;
+            }
+            continue;
+        }
+
+        const auto middle = begin + (end - begin) / 2u;
+        if (range.compare_exchange_strong(current, Pack(begin, middle), std::memory_order_acq_rel))
+        {
+            m_ranges[worker].value.store(Pack(middle, end), std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+}  // namespace ocra::runtime
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <inttypes.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace ocra::runtime
+{
+// Fixed set of worker threads for data parallel jobs. A job is a range of indices split evenly
+// between the workers, a worker takes chunks of 'grain' indices from the front of its own range
+// and, when it runs out, steals the back half of the range of another worker. The thread
+// calling ParallelFor is one of the workers, so a pool of 1 runs everything on the caller
+class ThreadPool
+{
+public:
+    // Called with [begin, end) of the indices and the index of the worker running it,
+    // a worker runs one chunk at a time
+    using Task = std::function<void(std::size_t begin, std::size_t end, std::size_t worker)>;
+
+    explicit ThreadPool(std::size_t workers = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    inline std::size_t Workers() const { return m_workers; }
+
+    // Runs 'task' over [0, count) and returns when all the indices are done. Jobs of many
+    // callers run one after another, the first exception of a task is rethrown here
+    void ParallelFor(std::size_t count, std::size_t grain, const Task& task);
+
+private:
+    // [begin, end) packed into one word, both ends change with one CAS
+    struct alignas(64) Range
+    {
+        std::atomic<uint64_t> value{};
+    };
+
+    void Run(std::size_t worker);
+    void Work(std::size_t worker);
+    bool Take(std::size_t worker, uint64_t& begin, uint64_t& end);
+    bool Steal(std::size_t worker);
+
+private:
+    std::size_t m_workers;
+    std::unique_ptr<Range[]> m_ranges;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_submit;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation{};
+    std::size_t m_running{};
+    bool m_isStopping{};
+
+    const Task* m_task{};
+    std::size_t m_offset{};
+    std::size_t m_grain{1u};
+    std::exception_ptr m_exception;
+};
+
+}  // namespace ocra::runtime
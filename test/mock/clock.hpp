@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ocra/ocra.hpp"
+
+
+namespace mock
+{
+
+class Clock : public ocra::Clock
+{
+public:
+    explicit Clock(uint64_t now = 0u) : m_now(now) {}
+
+    void Set(uint64_t now) { m_now = now; }
+    uint64_t Now() const override { return m_now; }
+
+private:
+    uint64_t m_now;
+};
+
+}  // namespace mock
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "ocra/ocra.hpp"
+#include "ocra/provider.hpp"
+
+
+namespace
+{
+thread_local std::size_t g_allocations = 0u;
+
+std::vector<uint8_t> Key(std::size_t size)
+{
+    auto result = std::vector<uint8_t>(size);
+    for (auto i = 0u; i < size; ++i)
+        result[i] = static_cast<uint8_t>('0' + (i + 1) % 10);
+    return result;
+}
+}  // namespace
+
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (auto pointer = std::malloc(size ? size : 1u))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+struct AllocationTestParams
+{
+    std::string suite;
+    ocra::OcraParameters parameters;
+    std::string result;
+};
+
+class AllocationTest : public ::testing::TestWithParam<AllocationTestParams>
+{};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, AllocationTest, ::testing::Values(
+    AllocationTestParams{"OCRA-1:HOTP-SHA1-6:QN08",
+                         ocra::OcraParameters{Key(20), {}, {}, {}, "11111111", {}}, "243178"},
+    AllocationTestParams{"OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1",
+                         ocra::OcraParameters{Key(32), 1u, {}, "1234", "12345678", {}}, "86775851"},
+    AllocationTestParams{"OCRA-1:HOTP-SHA512-8:QN08-T1M",
+                         ocra::OcraParameters{Key(64), {}, 0x132d0b6, {}, "00000000", {}}, "95209754"},
+    AllocationTestParams{"OCRA-1:HOTP-SHA256-8:QA08",
+                         ocra::OcraParameters{Key(32), {}, {}, {}, "SIG10000", {}}, "53095496"}
+));
+
+TEST_P(AllocationTest, ShouldComputeWithoutAllocationInSteadyState)
+{
+    const auto ocra = ocra::Ocra(GetParam().suite);
+    const auto key = ocra.Prepare(GetParam().parameters.key);
+    ASSERT_EQ(ocra.Compute(GetParam().parameters, key).View(), GetParam().result);
+
+    const auto allocations = g_allocations;
+    auto result = ocra::OtpResult{};
+    for (auto i = 0; i < 100; ++i)
+        result = ocra.Compute(GetParam().parameters, key);
+    ASSERT_EQ(g_allocations, allocations);
+    ASSERT_EQ(result.View(), GetParam().result);
+}
+
+TEST_P(AllocationTest, ShouldHashBatchByProviderWithoutAllocationInSteadyState)
+{
+    const auto ocra = ocra::Ocra(GetParam().suite);
+    const auto hmac = ocra.Suite().hmac;
+    ocra::RegisterProvider(hmac, &ocra::BuiltinProvider(hmac));
+    ocra::RegisterProvider(ocra::OcraSha::SHA1, &ocra::BuiltinProvider(ocra::OcraSha::SHA1));
+    const ocra::OcraParametersView requests[] = {GetParam().parameters, GetParam().parameters};
+    ocra::OtpResult results[2];
+    const auto batch = [&]()
+    {
+        return ocra(ocra::Span<const ocra::OcraParametersView>(requests, 2u), ocra::Span<ocra::OtpResult>(results, 2u));
+    };
+    ASSERT_EQ(batch(), 2u);
+
+    const auto allocations = g_allocations;
+    for (auto i = 0; i < 100; ++i)
+        batch();
+    ASSERT_EQ(g_allocations, allocations);
+    ASSERT_EQ(results[1].View(), GetParam().result);
+    ocra::RegisterProvider(hmac, nullptr);
+    ocra::RegisterProvider(ocra::OcraSha::SHA1, nullptr);
+}
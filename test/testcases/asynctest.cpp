@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ocra/ocra.hpp"
+#include "runtime/async.hpp"
+#include "runtime/executor.hpp"
+#include "hashfunctions.hpp"
+
+
+namespace
+{
+// Stand-in of a remote signer, the HMAC is computed by its own thread
+class SignerProvider : public ocra::runtime::AsyncHashProvider
+{
+public:
+    void Hmac(ocra::OcraHmac hmac, ocra::Span<const uint8_t> key, ocra::Span<const uint8_t> message,
+              ocra::Span<uint8_t> digest, Done done) const override
+    {
+        ++calls;
+        m_signer.Post([=]() {
+            const auto algorithm = static_cast<ocra::hash::Algorithm>(hmac);
+            auto context = ocra::hash::HmacContext(algorithm, key.data(), key.size());
+            context.Update(message.data(), message.size());
+            context.Final(digest.data());
+            done(!isFailing && digest.size() == ocra::hash::DigestSize(algorithm));
+        });
+    }
+
+public:
+    mutable std::atomic<int> calls{};
+    bool isFailing{};
+
+private:
+    mutable ocra::runtime::ThreadExecutor m_signer;
+};
+
+// Keeps the requests until Release, as a signer which has not answered yet
+class GatedProvider : public ocra::runtime::AsyncHashProvider
+{
+public:
+    void Hmac(ocra::OcraHmac, ocra::Span<const uint8_t>, ocra::Span<const uint8_t>,
+              ocra::Span<uint8_t>, Done done) const override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(done));
+    }
+
+    std::size_t Pending() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending.size();
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& done : m_pending)
+            done(false);
+        m_pending.clear();
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    mutable std::vector<Done> m_pending;
+};
+
+ocra::OcraParameters Parameters(uint64_t counter)
+{
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>{0x31, 0x32, 0x33, 0x34};
+    parameters.counter = counter;
+    parameters.password = "1234";
+    parameters.question = "12345678";
+    return parameters;
+}
+
+ocra::OtpResult Compute(const ocra::runtime::AsyncOcra& ocra, const ocra::OcraParametersView& parameters)
+{
+    auto promise = std::promise<ocra::OtpResult>{};
+    ocra.ComputeAsync(parameters, [&](const ocra::OtpResult& result) { promise.set_value(result); });
+    return promise.get_future().get();
+}
+
+ocra::VerifyResult Verify(const ocra::runtime::AsyncOcra& ocra, const ocra::OcraParametersView& parameters,
+                          std::string_view response, uint64_t window)
+{
+    auto promise = std::promise<ocra::VerifyResult>{};
+    ocra.VerifyAsync(parameters, response, window, [&](const ocra::VerifyResult& result) { promise.set_value(result); });
+    return promise.get_future().get();
+}
+}  // namespace
+
+
+TEST(ThreadExecutorTest, ShouldRunPostedWorksBeforeDestruction)
+{
+    auto count = std::atomic<int>{};
+    {
+        auto executor = ocra::runtime::ThreadExecutor(3u);
+        for (auto i = 0; i < 1000; ++i)
+            executor.Post([&]() { ++count; });
+    }
+    ASSERT_EQ(count.load(), 1000);
+}
+
+
+class AsyncOcraTest : public ::testing::TestWithParam<bool>
+{
+public:
+    void SetUp() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({
+            ocra::OcraHmac::HOTP_SHA1,
+            ocra::OcraHmac::HOTP_SHA256,
+            ocra::OcraHmac::HOTP_SHA512});
+        mock::OcraHashFunction().SetAvailableShaAlgorithm({
+            ocra::OcraSha::SHA1});
+    }
+
+    void TearDown() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+        mock::OcraHashFunction().SetAvailableShaAlgorithm({});
+    }
+
+    const ocra::runtime::AsyncHashProvider* Provider() const { return GetParam() ? &signer : nullptr; }
+
+public:
+    // The executor finishes its works, which post to the signer, before the signer is gone
+    const ocra::Ocra ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1");
+    SignerProvider signer;
+    ocra::runtime::ThreadExecutor executor{2u};
+};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, AsyncOcraTest, ::testing::Values(false, true));
+
+TEST_P(AsyncOcraTest, ShouldComputeAsOcra)
+{
+    const auto async = ocra::runtime::AsyncOcra(ocra, executor, Provider());
+    for (auto counter = 0u; counter < 20u; ++counter)
+    {
+        const auto parameters = Parameters(counter);
+        const auto result = Compute(async, parameters);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result.View(), ocra.Compute(parameters).View());
+    }
+    ASSERT_EQ(signer.calls.load(), GetParam() ? 20 : 0);
+}
+
+TEST_P(AsyncOcraTest, ShouldVerifyAsOcra)
+{
+    const auto async = ocra::runtime::AsyncOcra(ocra, executor, Provider());
+    const auto response = std::string(ocra.Compute(Parameters(7u)).View());
+    for (auto window : {0u, 3u, 10u})
+    {
+        const auto result = Verify(async, Parameters(4u), response, window);
+        const auto expected = ocra.TryVerify(Parameters(4u), response, window);
+        ASSERT_EQ(result.status, expected.status);
+        ASSERT_EQ(result.isMatch, expected.isMatch);
+        ASSERT_EQ(result.offset, expected.offset);
+    }
+    ASSERT_TRUE(Verify(async, Parameters(4u), response, 3u));
+    ASSERT_EQ(Verify(async, Parameters(4u), response, 3u).offset, 3u);
+}
+
+TEST_P(AsyncOcraTest, ShouldReportCodesOfInvalidRequests)
+{
+    const auto async = ocra::runtime::AsyncOcra(ocra, executor, Provider());
+    auto parameters = Parameters(1u);
+    parameters.question = "3215j";
+    ASSERT_EQ(Compute(async, parameters).status, 0x15);
+    ASSERT_EQ(Verify(async, parameters, "12345678", 2u).status, 0x15);
+
+    parameters = Parameters(1u);
+    parameters.key.clear();
+    ASSERT_EQ(Compute(async, parameters).status, 0x10);
+
+    parameters = Parameters(1u);
+    parameters.counter.reset();
+    ASSERT_EQ(Verify(async, parameters, "12345678", 2u).status, 0x12);
+    parameters.counter = UINT64_MAX - 1u;
+    ASSERT_EQ(Verify(async, parameters, "12345678", 2u).status, 0x28);
+
+    const auto suite = ocra::runtime::AsyncOcra(ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08"), executor, Provider());
+    ASSERT_EQ(Verify(suite, Parameters(1u), "123456", 2u).status, 0x21);
+    ASSERT_FALSE(Verify(suite, Parameters(1u), "123456", 0u).isMatch);
+    ASSERT_EQ(Verify(suite, Parameters(1u), "123456", 0u).status, 0);
+}
+
+TEST_P(AsyncOcraTest, ShouldComputeOddSessionInfoAsOcra)
+{
+    for (const auto& [suite, sessionInfo] : {std::make_pair("OCRA-1:HOTP-SHA1-6:QN08-S001", "A"),
+                                             std::make_pair("OCRA-1:HOTP-SHA1-6:QN08-S003", "ABC")})
+    {
+        const auto sessionOcra = ocra::Ocra(suite);
+        const auto async = ocra::runtime::AsyncOcra(sessionOcra, executor, Provider());
+        auto parameters = Parameters(0u);
+        parameters.sessionInfo = sessionInfo;
+        const auto result = Compute(async, parameters);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result.View(), sessionOcra.Compute(parameters).View());
+    }
+}
+
+TEST_P(AsyncOcraTest, ShouldVerifySingleSessionByteAsOcra)
+{
+    // The message of an operation is sized exactly, the session byte must stay inside it
+    const auto sessionOcra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1-S001");
+    const auto async = ocra::runtime::AsyncOcra(sessionOcra, executor, Provider());
+    auto parameters = Parameters(7u);
+    parameters.sessionInfo = "F";
+    const auto response = std::string(sessionOcra.Compute(parameters).View());
+
+    parameters.counter = 4u;
+    const auto result = Verify(async, parameters, response, 5u);
+    ASSERT_EQ(result.status, 0);
+    ASSERT_TRUE(result.isMatch);
+    ASSERT_EQ(result.offset, 3u);
+    ASSERT_EQ(Compute(async, parameters).View(), sessionOcra.Compute(parameters).View());
+}
+
+TEST_P(AsyncOcraTest, ShouldVerifyAcrossChunksAsOcra)
+{
+    const auto async = ocra::runtime::AsyncOcra(ocra, executor, Provider());
+    const auto response = std::string(ocra.Compute(Parameters(104u)).View());
+    for (auto window : {63u, 99u, 100u, 150u})
+    {
+        const auto result = Verify(async, Parameters(4u), response, window);
+        const auto expected = ocra.TryVerify(Parameters(4u), response, window);
+        ASSERT_EQ(result.status, expected.status);
+        ASSERT_EQ(result.isMatch, expected.isMatch);
+        ASSERT_EQ(result.offset, expected.offset);
+    }
+    ASSERT_EQ(Verify(async, Parameters(4u), response, 150u).offset, 100u);
+}
+
+TEST(AsyncOcraFailureTest, ShouldFailOnFailedProvider)
+{
+    auto signer = SignerProvider{};
+    auto executor = ocra::runtime::ThreadExecutor{};
+    signer.isFailing = true;
+    const auto async = ocra::runtime::AsyncOcra(ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08"), executor, &signer);
+    ASSERT_EQ(Compute(async, Parameters(0u)).status, 0x11);
+    ASSERT_EQ(Verify(async, Parameters(0u), "123456", 0u).status, 0x11);
+}
+
+TEST(AsyncOcraFailureTest, ShouldNotBlockExecutorWhileProviderWaits)
+{
+    // One thread only, every call reaches the provider while the others wait for it
+    auto executor = ocra::runtime::ThreadExecutor(1u);
+    auto provider = GatedProvider{};
+    const auto async = ocra::runtime::AsyncOcra(ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08"), executor, &provider);
+
+    // The inputs stay valid until 'done'
+    const auto parameters = Parameters(0u);
+    auto done = std::atomic<int>{};
+    for (auto i = 0; i < 3; ++i)
+        async.ComputeAsync(parameters, [&](const ocra::OtpResult& result) { done += result.status == 0x11; });
+    while (provider.Pending() < 3u)
+        std::this_thread::yield();
+    ASSERT_EQ(done.load(), 0);
+
+    provider.Release();
+    while (done.load() < 3)
+        std::this_thread::yield();
+}
+
+TEST(AsyncOcraFailureTest, ShouldStartCandidatesOfChunkAtOnce)
+{
+    auto executor = ocra::runtime::ThreadExecutor(1u);
+    auto provider = GatedProvider{};
+    const auto async = ocra::runtime::AsyncOcra(ocra::Ocra("OCRA-1:HOTP-SHA1-6:C-QN08"), executor, &provider);
+
+    const auto parameters = Parameters(0u);
+    auto status = std::atomic<int>{-1};
+    async.VerifyAsync(parameters, "123456", 100u, [&](const ocra::VerifyResult& result) { status = result.status; });
+    while (provider.Pending() < 64u)
+        std::this_thread::yield();
+    ASSERT_EQ(status.load(), -1);
+
+    provider.Release();
+    while (status.load() < 0)
+        std::this_thread::yield();
+    ASSERT_EQ(status.load(), 0x11);
+    ASSERT_EQ(provider.Pending(), 0u);
+}
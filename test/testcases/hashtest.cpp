@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "hash/hash.hpp"
+#include "hashfunctions.hpp"
+
+
+namespace
+{
+std::vector<uint8_t> Bytes(const std::string& value)
+{
+    return std::vector<uint8_t>(value.begin(), value.end());
+}
+
+std::vector<uint8_t> Hex(const std::string& value)
+{
+    auto result = std::vector<uint8_t>{};
+    for (auto i = 0u; i + 1 < value.size(); i += 2)
+        result.push_back(static_cast<uint8_t>(std::stoi(value.substr(i, 2), nullptr, 16)));
+    return result;
+}
+
+std::vector<uint8_t> Digest(ocra::hash::Algorithm algorithm, const std::vector<uint8_t>& data)
+{
+    auto result = std::vector<uint8_t>(ocra::hash::DigestSize(algorithm));
+    ocra::hash::Digest(algorithm, data.data(), data.size(), result.data());
+    return result;
+}
+
+std::vector<uint8_t> Hmac(ocra::hash::Algorithm algorithm,
+                          const std::vector<uint8_t>& key,
+                          const std::vector<uint8_t>& data)
+{
+    auto result = std::vector<uint8_t>(ocra::hash::DigestSize(algorithm));
+    ocra::hash::Hmac(algorithm, key.data(), key.size(), data.data(), data.size(), result.data());
+    return result;
+}
+}  // namespace
+
+
+class HashTest : public ::testing::TestWithParam<ocra::hash::Kernel>
+{
+public:
+    void SetUp() override
+    {
+        if (!ocra::hash::UseKernel(GetParam()))
+            GTEST_SKIP() << "Kernel is not supported by this CPU";
+
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({
+            ocra::OcraHmac::HOTP_SHA1,
+            ocra::OcraHmac::HOTP_SHA256,
+            ocra::OcraHmac::HOTP_SHA512});
+    }
+
+    void TearDown() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+        ocra::hash::UseKernel(ocra::hash::DetectKernel());
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, HashTest, ::testing::Values(
+    ocra::hash::Kernel::Portable,
+    ocra::hash::Kernel::Avx2,
+    ocra::hash::Kernel::ShaNi,
+    ocra::hash::Kernel::Avx512
+));
+
+TEST_P(HashTest, ShouldComputeKnownDigests)
+{
+    using ocra::hash::Algorithm;
+
+    const auto abc = Bytes("abc");
+    const auto twoBlocks = Bytes("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+    const auto sha512TwoBlocks = Bytes("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+                                       "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu");
+
+    ASSERT_EQ(Digest(Algorithm::SHA1, abc), Hex("a9993e364706816aba3e25717850c26c9cd0d89d"));
+    ASSERT_EQ(Digest(Algorithm::SHA1, twoBlocks), Hex("84983e441c3bd26ebaae4aa1f95129e5e54670f1"));
+    ASSERT_EQ(Digest(Algorithm::SHA256, abc),
+              Hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    ASSERT_EQ(Digest(Algorithm::SHA256, twoBlocks),
+              Hex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+    ASSERT_EQ(Digest(Algorithm::SHA512, abc),
+              Hex("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                  "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+    ASSERT_EQ(Digest(Algorithm::SHA512, sha512TwoBlocks),
+              Hex("8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+                  "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"));
+}
+
+TEST_P(HashTest, ShouldComputeKnownHmacs)
+{
+    using ocra::hash::Algorithm;
+
+    const auto key = Bytes("Jefe");
+    const auto data = Bytes("what do ya want for nothing?");
+
+    ASSERT_EQ(Hmac(Algorithm::SHA1, key, data), Hex("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"));
+    ASSERT_EQ(Hmac(Algorithm::SHA256, key, data),
+              Hex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+    ASSERT_EQ(Hmac(Algorithm::SHA512, key, data),
+              Hex("164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+                  "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"));
+}
+
+TEST_P(HashTest, ShouldMatchReferenceHmacForAllLengths)
+{
+    for (const auto hmac : {ocra::OcraHmac::HOTP_SHA1, ocra::OcraHmac::HOTP_SHA256, ocra::OcraHmac::HOTP_SHA512})
+    {
+        const auto algorithm = static_cast<ocra::hash::Algorithm>(hmac);
+        for (auto size = 0u; size < 300u; size += 7u)
+        {
+            auto key = std::vector<uint8_t>(size % 150u + 1u);
+            auto data = std::vector<uint8_t>(size);
+            for (auto i = 0u; i < key.size(); ++i)
+                key[i] = static_cast<uint8_t>(i * 31u + size);
+            for (auto i = 0u; i < data.size(); ++i)
+                data[i] = static_cast<uint8_t>(i * 7u + 3u);
+
+            ASSERT_EQ(Hmac(algorithm, key, data),
+                      mock::OcraHashFunction::Hmac(data, key.data(), key.size(), hmac));
+        }
+    }
+}
+
+TEST_P(HashTest, ShouldHashIncrementally)
+{
+    using ocra::hash::Algorithm;
+
+    auto data = std::vector<uint8_t>(1000u);
+    for (auto i = 0u; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i);
+
+    for (const auto algorithm : {Algorithm::SHA1, Algorithm::SHA256, Algorithm::SHA512})
+    {
+        auto context = ocra::hash::Context(algorithm);
+        for (auto pos = 0u, step = 1u; pos < data.size(); pos += step, step = step * 3u % 131u)
+            context.Update(data.data() + pos, std::min<std::size_t>(step, data.size() - pos));
+
+        auto digest = std::vector<uint8_t>(ocra::hash::DigestSize(algorithm));
+        context.Final(digest.data());
+        ASSERT_EQ(digest, Digest(algorithm, data));
+    }
+}
+
+TEST_P(HashTest, ShouldComputeHmacLanesAsSingleHmacs)
+{
+    for (const auto algorithm : {ocra::hash::Algorithm::SHA1, ocra::hash::Algorithm::SHA256, ocra::hash::Algorithm::SHA512})
+    {
+        for (const auto size : {0u, 1u, 55u, 56u, 64u, 111u, 112u, 128u, 227u, 300u})
+        {
+            constexpr auto COUNT = 2 * ocra::hash::MAX_LANES + 3u;
+            std::vector<uint8_t> keys[COUNT], messages[COUNT], digests[COUNT];
+            const uint8_t* keyPointers[COUNT];
+            const uint8_t* messagePointers[COUNT];
+            uint8_t* digestPointers[COUNT];
+            std::size_t keySizes[COUNT];
+
+            for (auto i = 0u; i < COUNT; ++i)
+            {
+                keys[i] = std::vector<uint8_t>(i * 11u % 150u);
+                messages[i] = std::vector<uint8_t>(size);
+                digests[i] = std::vector<uint8_t>(ocra::hash::DigestSize(algorithm));
+                for (auto j = 0u; j < keys[i].size(); ++j)
+                    keys[i][j] = static_cast<uint8_t>(j * 13u + i);
+                for (auto j = 0u; j < size; ++j)
+                    messages[i][j] = static_cast<uint8_t>(j * 5u + i * 3u);
+
+                keyPointers[i] = keys[i].data();
+                keySizes[i] = keys[i].size();
+                messagePointers[i] = messages[i].data();
+                digestPointers[i] = digests[i].data();
+            }
+
+            for (auto count = 0u; count <= COUNT; count += 5u)
+            {
+                ocra::hash::HmacLanes(algorithm, count, keyPointers, keySizes, messagePointers, size, digestPointers);
+                for (auto i = 0u; i < count; ++i)
+                    ASSERT_EQ(digests[i], Hmac(algorithm, keys[i], messages[i]));
+            }
+        }
+    }
+}
+
+TEST_P(HashTest, ShouldComputeHmacLanesUnderPreparedKey)
+{
+    for (const auto algorithm : {ocra::hash::Algorithm::SHA1, ocra::hash::Algorithm::SHA256, ocra::hash::Algorithm::SHA512})
+    {
+        const auto key = Bytes("a key for all the lanes");
+        const auto context = ocra::hash::HmacContext(algorithm, key.data(), key.size());
+        for (const auto size : {0u, 20u, 64u, 130u})
+        {
+            constexpr auto COUNT = ocra::hash::MAX_LANES + 3u;
+            std::vector<uint8_t> messages[COUNT], digests[COUNT];
+            const uint8_t* messagePointers[COUNT];
+            uint8_t* digestPointers[COUNT];
+            for (auto i = 0u; i < COUNT; ++i)
+            {
+                messages[i] = std::vector<uint8_t>(size, static_cast<uint8_t>(i));
+                digests[i] = std::vector<uint8_t>(ocra::hash::DigestSize(algorithm));
+                messagePointers[i] = messages[i].data();
+                digestPointers[i] = digests[i].data();
+            }
+
+            ocra::hash::HmacLanes(context, COUNT, messagePointers, size, digestPointers);
+            for (auto i = 0u; i < COUNT; ++i)
+                ASSERT_EQ(digests[i], Hmac(algorithm, key, messages[i]));
+        }
+    }
+}
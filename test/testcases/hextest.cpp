@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "ocra/hex.hpp"
+
+
+namespace
+{
+// Character by character decoding, the one used before the vectorized decoder
+bool Reference(uint8_t* output, const char* input, std::size_t length, bool isAlignRight)
+{
+    if (length > 2 && input[1] == 'x')
+    {
+        length -= 2;
+        input += 2;
+    }
+
+    auto relativePos = std::size_t{(length % 2) && isAlignRight};
+    for (auto i = 0u; i < length; ++i)
+    {
+        const auto& c = toupper(input[i]);
+        if ('0' <= c  && c <= '9')
+            output[relativePos] |= (c - '0');
+        else if ('A' <= c  && c <= 'F')
+            output[relativePos] |= (10 + c - 'A');
+        else
+            return false;
+
+        if (i % 2)
+            ++relativePos;
+        else
+            output[relativePos] <<= 4;
+    }
+    return true;
+}
+
+std::string Hex(std::size_t length, std::size_t seed)
+{
+    constexpr char CHARACTERS[] = "0123456789abcdefABCDEF";
+    auto result = std::string(length, '0');
+    for (auto i = 0u; i < length; ++i)
+        result[i] = CHARACTERS[(i * 5u + seed * 11u + i / 7u) % 22u];
+    return result;
+}
+}  // namespace
+
+
+TEST(HexDecodeTest, ShouldDecodeAsCharacterDecoder)
+{
+    for (const auto isAlignRight : {false, true})
+    {
+        for (auto length = 0u; length < 200u; ++length)
+        {
+            const auto hex = Hex(length, length);
+            auto expected = std::vector<uint8_t>(length + 2u);
+            auto result = std::vector<uint8_t>(length + 2u);
+
+            ASSERT_TRUE(Reference(expected.data(), hex.c_str(), hex.size(), isAlignRight));
+            ASSERT_TRUE(ocra::DecodeHex(hex, result.data(), isAlignRight));
+            ASSERT_EQ(result, expected) << hex;
+        }
+    }
+}
+
+TEST(HexDecodeTest, ShouldRejectInvalidCharacterAtAnyPosition)
+{
+    for (const auto invalid : {'g', 'G', 'x', ' ', '/', ':', '@', '`', '\0', '\x80', '\xc1'})
+    {
+        for (auto length = 1u; length < 70u; ++length)
+        {
+            auto hex = Hex(length, 3u);
+            hex[length * 7u % length] = invalid;
+            auto expected = std::vector<uint8_t>(length + 2u);
+            auto result = std::vector<uint8_t>(length + 2u);
+
+            const auto isValid = Reference(expected.data(), hex.c_str(), hex.size(), false);
+            ASSERT_EQ(ocra::DecodeHex(hex, result.data()), isValid) << hex;
+        }
+    }
+}
+
+TEST(HexDecodeTest, ShouldSkipPrefixAndImportKey)
+{
+    auto key = std::vector<uint8_t>{};
+    ASSERT_TRUE(ocra::DecodeHex("0x31323334", key));
+    ASSERT_EQ(key, (std::vector<uint8_t>{0x31, 0x32, 0x33, 0x34}));
+    ASSERT_TRUE(ocra::DecodeHex("AbC", key));
+    ASSERT_EQ(key, (std::vector<uint8_t>{0xab, 0xc0}));
+    ASSERT_FALSE(ocra::DecodeHex("0x0x12", key));
+    ASSERT_TRUE(key.empty());
+}
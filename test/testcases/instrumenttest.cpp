@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "ocra/hex.hpp"
+#include "ocra/instrument.hpp"
+#include "ocra/ocra.hpp"
+#include "ocra/provider.hpp"
+#include "exception.hpp"
+
+
+namespace
+{
+ocra::OcraParameters Parameters(std::string question)
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930313233343536373839303132", parameters.key);
+    parameters.question = std::move(question);
+    parameters.password = "1234";
+    return parameters;
+}
+}  // namespace
+
+
+class InstrumentTestFixture : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, &ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA256));
+        ocra::RegisterProvider(ocra::OcraSha::SHA1, &ocra::BuiltinProvider(ocra::OcraSha::SHA1));
+    }
+
+    void TearDown() override
+    {
+        ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, nullptr);
+        ocra::RegisterProvider(ocra::OcraSha::SHA1, nullptr);
+    }
+
+    // Failures of the function call operator, in both builds
+    static void Call(ocra::Ocra& ocra, const ocra::OcraParameters& parameters)
+    {
+        #ifdef OCRA_NO_THROW
+        ocra(parameters);
+        #else
+        try
+        {
+            ocra(parameters);
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+        #endif
+    }
+};
+
+
+#ifdef OCRA_INSTRUMENT
+namespace
+{
+ocra::StageStatistics Difference(const ocra::Statistics& after, const ocra::Statistics& before, ocra::Stage stage)
+{
+    return {after[stage].calls - before[stage].calls, after[stage].errors - before[stage].errors,
+            after[stage].nanoseconds - before[stage].nanoseconds};
+}
+}  // namespace
+
+
+TEST_F(InstrumentTestFixture, ShouldCountStagesOfCall)
+{
+    const auto before = ocra::CollectStatistics();
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08-PSHA1");
+    ASSERT_EQ(ocra(Parameters("00000000")), "83238735");
+    Call(ocra, Parameters("1234567x"));
+    const auto after = ocra::CollectStatistics();
+
+    const auto validate = Difference(after, before, ocra::Stage::Validate);
+    ASSERT_EQ(validate.calls, 1u);
+    ASSERT_EQ(validate.errors, 0u);
+
+    const auto call = Difference(after, before, ocra::Stage::Call);
+    ASSERT_EQ(call.calls, 2u);
+    ASSERT_EQ(call.errors, 1u);
+    ASSERT_EQ(after.errors[0x15] - before.errors[0x15], 1u);
+
+    const auto assemble = Difference(after, before, ocra::Stage::Assemble);
+    ASSERT_EQ(assemble.calls, 2u);
+    ASSERT_EQ(assemble.errors, 1u);
+
+    // The rejected request is neither hashed nor truncated
+    ASSERT_EQ(Difference(after, before, ocra::Stage::PasswordHash).calls, 1u);
+    ASSERT_EQ(Difference(after, before, ocra::Stage::Hmac).calls, 1u);
+    ASSERT_EQ(Difference(after, before, ocra::Stage::Truncate).calls, 1u);
+}
+
+TEST_F(InstrumentTestFixture, ShouldEstimateTimeOfStages)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08-PSHA1");
+    for (auto i = 0u; i < 2u * ocra::instrument::TIMING_PERIOD; ++i)
+        ocra(Parameters("00000000"));
+
+    const auto statistics = ocra::CollectStatistics();
+    ASSERT_GT(statistics[ocra::Stage::Call].nanoseconds, 0u);
+    ASSERT_GT(statistics[ocra::Stage::Hmac].nanoseconds, 0u);
+}
+
+TEST_F(InstrumentTestFixture, ShouldAggregateThreads)
+{
+    const auto before = ocra::CollectStatistics();
+    std::thread first([]() { ocra::Ocra::TryFrom("OCRA-1:HOTP-SHA1-6:QN08"); });
+    std::thread second([]() { ocra::Ocra::TryFrom("OCRA-1:HOTP-SHA1-6:QN65"); });
+    first.join();
+    second.join();
+
+    // The counters of the finished threads stay in the sum
+    const auto after = ocra::CollectStatistics();
+    const auto validate = Difference(after, before, ocra::Stage::Validate);
+    ASSERT_EQ(validate.calls, 2u);
+    ASSERT_EQ(validate.errors, 1u);
+    ASSERT_EQ(after.errors[0x09] - before.errors[0x09], 1u);
+}
+#else
+TEST_F(InstrumentTestFixture, ShouldNotCountWithoutInstrumentation)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08-PSHA1");
+    ASSERT_EQ(ocra(Parameters("00000000")), "83238735");
+    Call(ocra, Parameters("1234567x"));
+
+    const auto statistics = ocra::CollectStatistics();
+    for (const auto& stage : statistics.stages)
+        ASSERT_EQ(stage.calls, 0u);
+}
+#endif
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/intern.hpp"
+#include "hashfunctions.hpp"
+
+
+namespace
+{
+ocra::OcraParameters Parameters(std::string question)
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930", parameters.key);
+    parameters.question = std::move(question);
+    return parameters;
+}
+}  // namespace
+
+
+class OcraInternTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({
+            ocra::OcraHmac::HOTP_SHA1,
+            ocra::OcraHmac::HOTP_SHA256,
+            ocra::OcraHmac::HOTP_SHA512});
+    }
+
+    void TearDown() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+    }
+};
+
+TEST_F(OcraInternTest, ShouldShareOneSuiteForAnyLetterCase)
+{
+    const auto& ocra = ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08");
+    ASSERT_EQ(&ocra, &ocra::Intern("ocra-1:hotp-sha1-6:qn08"));
+    ASSERT_EQ(&ocra, &ocra::Intern(std::string("OCRA-1:HOTP-SHA1-6:QN08")));
+    ASSERT_NE(&ocra, &ocra::Intern("OCRA-1:HOTP-SHA1-8:QN08"));
+    ASSERT_EQ(ocra.Suite().to_string(), "OCRA-1:HOTP-SHA1-6:QN08");
+}
+
+TEST_F(OcraInternTest, ShouldComputeWithSharedSuite)
+{
+    const auto& ocra = ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08");
+    ASSERT_EQ(ocra.Compute(Parameters("00000000")).View(), "237653");
+    ASSERT_EQ(ocra.Compute(Parameters("99999999")).View(), "294470");
+}
+
+TEST_F(OcraInternTest, ShouldInternOnceFromManyThreads)
+{
+    constexpr auto THREADS = 8u;
+    constexpr auto SUITES = 100u;
+    auto suites = std::vector<std::string>{};
+    for (auto i = 0u; i < SUITES; ++i)
+        suites.push_back("OCRA-1:HOTP-SHA256-8:QN08-S" + std::to_string(100u + i));
+
+    auto interned = std::vector<std::vector<const ocra::Ocra*>>(THREADS, std::vector<const ocra::Ocra*>(SUITES));
+    auto otps = std::vector<std::string>(THREADS);
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0u; t < THREADS; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (auto i = 0u; i < SUITES; ++i)
+                interned[t][(i + 7u * t) % SUITES] = &ocra::Intern(suites[(i + 7u * t) % SUITES]);
+            otps[t] = std::string(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08").Compute(Parameters("11111111")).View());
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto t = 1u; t < THREADS; ++t)
+    {
+        ASSERT_EQ(interned[t], interned[0]);
+        ASSERT_EQ(otps[t], "243178");
+    }
+    for (auto i = 0u; i < SUITES; ++i)
+        ASSERT_EQ(interned[0][i]->Plan().sessionLength, 100u + i);
+}
+
+TEST_F(OcraInternTest, ShouldFailOnInvalidSuite)
+{
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN65").Status(), 0x09);
+    ASSERT_EQ(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN65").Compute(Parameters("1")).status, 0x01);
+
+    // Not added to the table, every invalid suite of a thread reuses one Ocra
+    const auto* invalid = &ocra::Intern("OCRA-1:HOTP-SHA1-6:QN65");
+    ASSERT_EQ(&ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08-X"), invalid);
+    ASSERT_NE(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08-X").Status(), 0);
+    ASSERT_EQ(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN08").Status(), 0);
+    #else
+    ASSERT_THROW(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN65"), std::invalid_argument);
+    ASSERT_THROW(ocra::Intern("OCRA-1:HOTP-SHA1-6:QN65"), std::invalid_argument);
+    #endif
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ocra/numeric.hpp"
+
+
+namespace
+{
+// Digit-by-digit long division, the encoding used before the limb encoder
+std::vector<uint8_t> Reference(const std::string& decimal)
+{
+    auto nibbles = std::vector<uint8_t>{};  // little-endian
+    for (const auto c : decimal)
+    {
+        auto carry = c - '0';
+        for (auto& nibble : nibbles)
+        {
+            const auto value = nibble * 10 + carry;
+            nibble = value % 16;
+            carry = value / 16;
+        }
+        for (; carry; carry /= 16)
+            nibbles.push_back(carry % 16);
+    }
+
+    auto result = std::vector<uint8_t>((nibbles.size() + 1u) / 2u);
+    for (auto i = 0u; i < nibbles.size(); ++i)
+        result[i / 2u] |= nibbles[nibbles.size() - 1u - i] << (i % 2u ? 0 : 4);
+    return result;
+}
+
+std::vector<uint8_t> Encode(const std::string& decimal, std::size_t capacity = 128u)
+{
+    auto result = std::vector<uint8_t>(capacity);
+    const auto size = ocra::EncodeNumericQuestion(decimal, result.data(), capacity);
+    if (size == SIZE_MAX)
+        return {0xde, 0xad};
+    result.resize(size);
+    return result;
+}
+}  // namespace
+
+
+TEST(NumericQuestionTest, ShouldEncodeKnownValues)
+{
+    ASSERT_EQ(Encode(""), std::vector<uint8_t>{});
+    ASSERT_EQ(Encode("0000"), std::vector<uint8_t>{});
+    ASSERT_EQ(Encode("15"), (std::vector<uint8_t>{0xf0}));
+    ASSERT_EQ(Encode("255"), (std::vector<uint8_t>{0xff}));
+    ASSERT_EQ(Encode("12345678"), (std::vector<uint8_t>{0xbc, 0x61, 0x4e}));
+    ASSERT_EQ(Encode("4294967296"), (std::vector<uint8_t>{0x10, 0x00, 0x00, 0x00, 0x00}));
+    ASSERT_EQ(Encode("18446744073709551616"), (std::vector<uint8_t>{0x10, 0, 0, 0, 0, 0, 0, 0, 0}));
+}
+
+TEST(NumericQuestionTest, ShouldMatchLongDivisionForAllLengths)
+{
+    auto decimal = std::string{};
+    for (auto length = 1u; length <= 308u; ++length)
+    {
+        decimal += static_cast<char>('0' + (length * 7u + length / 3u) % 10u);
+        ASSERT_EQ(Encode(decimal), Reference(decimal)) << decimal;
+        ASSERT_EQ(Encode(std::string(length, '9')), Reference(std::string(length, '9')));
+    }
+}
+
+TEST(NumericQuestionTest, ShouldRejectInvalidQuestions)
+{
+    const auto invalid = std::vector<uint8_t>{0xde, 0xad};
+    ASSERT_EQ(Encode("1234567a"), invalid);
+    ASSERT_EQ(Encode("12345678901234:6789"), invalid);
+    ASSERT_EQ(Encode("-1"), invalid);
+    ASSERT_EQ(Encode(std::string(309u, '9')), invalid);
+    ASSERT_EQ(Encode("4294967296", 4u), invalid);
+    ASSERT_EQ(Encode("4294967295", 4u), (std::vector<uint8_t>{0xff, 0xff, 0xff, 0xff}));
+}
+
+TEST(NumericQuestionTest, ShouldEncodeQuestionsInBatch)
+{
+    const std::string_view questions[] = {"12345678", "x", "255", "", "4294967296"};
+    uint8_t output[5][8] = {};
+    std::size_t sizes[5] = {};
+
+    ASSERT_EQ(ocra::EncodeNumericQuestions(questions, output[0], 8u, sizes), 4u);
+    ASSERT_EQ(sizes[0], 3u);
+    ASSERT_EQ(sizes[1], SIZE_MAX);
+    ASSERT_EQ(sizes[2], 1u);
+    ASSERT_EQ(sizes[3], 0u);
+    ASSERT_EQ(sizes[4], 5u);
+    ASSERT_EQ(output[0][0], 0xbc);
+    ASSERT_EQ(output[2][0], 0xff);
+    ASSERT_EQ(output[4][0], 0x10);
+}
@@ -1,12 +1,28 @@
 #include <gtest/gtest.h>
 
 #include "ocra/ocra.hpp"
+#include "clock.hpp"
 #include "exception.hpp"
+#include "hashfunctions.hpp"
 
 
 class OcraFailureTestFixture : public ::testing::Test
 {
 public:
+    void SetUp() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({
+            ocra::OcraHmac::HOTP_SHA1,
+            ocra::OcraHmac::HOTP_SHA256,
+            ocra::OcraHmac::HOTP_SHA512});
+    }
+
+    void TearDown() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+        mock::OcraHashFunction().SetAvailableShaAlgorithm({});
+    }
+
     auto Get(std::string suite, ocra::OcraParameters params)
     {
         auto ocra = ocra::Ocra(std::move(suite));
@@ -110,3 +126,272 @@ TEST_F(OcraFailureTestFixture, ShouldFailOnConcatenateTimestampIfIsMissing)
                          "OCRA operator() failed, suite contains a timestamp, but no timestamp value in parameters");
     ASSERT_RETURN_STATUS(Get(std::move(ocraSuite), std::move(ocraParams)), 0x19);
 }
+
+TEST_F(OcraFailureTestFixture, ShouldFailWithEmptyPreparedKey)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QA08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.question = "hello";
+
+    ASSERT_THROW_MESSAGE(ocra(ocraParams, ocra.Prepare({})),
+                         "OCRA operator() failed, missing parameter 'key', required for HMAC");
+    ASSERT_RETURN_STATUS((ocra(ocraParams, ocra.Prepare({})), ocra), 0x10);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailWithPreparedKeyForDifferentHmac)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QA08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.question = "hello";
+    const auto key = ocra::PreparedKey({0x1, 0xff, 0x4}, ocra::OcraHmac::HOTP_SHA1);
+
+    ASSERT_THROW_MESSAGE(ocra(ocraParams, key),
+                         "OCRA operator() failed, prepared key was created for a different HMAC algorithm");
+    ASSERT_RETURN_STATUS((ocra(ocraParams, key), ocra), 0x1F);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnlyInvalidRequestsOfBatch)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08");
+    auto parameters = std::vector<ocra::OcraParameters>(20u);
+    for (auto i = 0u; i < parameters.size(); ++i)
+    {
+        parameters[i].key = std::vector<uint8_t>{0x1, 0xff, static_cast<uint8_t>(i)};
+        parameters[i].question = "12345678";
+    }
+    parameters[3].key.clear();
+    parameters[7].question = "3215j";
+    parameters[9].question.reset();
+
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra.Compute(parameters, results), parameters.size() - 3u);
+    ASSERT_EQ(results[3].status, 0x10);
+    ASSERT_EQ(results[7].status, 0x15);
+    ASSERT_EQ(results[9].status, 0x13);
+    ASSERT_FALSE(results[3]);
+    ASSERT_TRUE(results[8]);
+    ASSERT_EQ(results[8].length, 8u);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldClearStatusOnSuccessfulCall)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.question = "12345678";
+
+    ASSERT_RETURN_STATUS((ocra(ocraParams), ocra), 0x10);
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ASSERT_RETURN_STATUS((ocra(ocraParams), ocra), 0x00);
+    ASSERT_RETURN_STATUS((ocra(ocraParams, ocra.Prepare({})), ocra), 0x10);
+    ASSERT_RETURN_STATUS((ocra(ocraParams, ocra.Prepare(ocraParams.key)), ocra), 0x00);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailBatchWithTooFewResults)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08");
+    auto parameters = std::vector<ocra::OcraParameters>(2u);
+    auto results = std::vector<ocra::OtpResult>(1u);
+
+    ASSERT_THROW_MESSAGE(ocra.Compute(parameters, results),
+                         "OCRA Compute() failed, there are fewer results than parameters");
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(ocra.Compute(parameters, results), 0u);
+    ASSERT_EQ(results[0].status, 0x20);
+    #endif
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailVerifyOfSuiteWithoutCounter)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.counter = 1u;
+
+    ASSERT_THROW_MESSAGE(ocra.Verify(ocraParams, "12345678", 10u),
+                         "OCRA Verify() failed, suite does not contain a counter");
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(ocra.Verify(ocraParams, "12345678", 10u).status, 0x21);
+    #endif
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailVerifyOfWindowPastLargestCounter)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.counter = UINT64_MAX - 2u;
+
+    ASSERT_THROW_MESSAGE(ocra.Verify(ocraParams, "12345678", 3u),
+                         "OCRA Verify() failed, counter window runs past the largest counter value");
+    ASSERT_EQ(ocra.TryVerify(ocraParams, "12345678", 3u).status, 0x28);
+    ASSERT_EQ(ocra.TryVerify(ocraParams, "12345678", 2u).status, 0);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldLimitVerifyWindow)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.counter = ocra::Ocra::MAX_WINDOW + 1u;
+    const auto response = std::string(ocra.TryCompute(ocraParams, ocra.Prepare(ocraParams.key)).View());
+
+    // Counters beyond the limit are not tried, an unbounded window ends at once
+    ocraParams.counter = 0u;
+    ASSERT_EQ(ocra.TryVerify(ocraParams, response, UINT64_MAX).status, 0);
+    ASSERT_FALSE(ocra.TryVerify(ocraParams, response, UINT64_MAX).isMatch);
+    ocraParams.counter = 1u;
+    ASSERT_EQ(ocra.TryVerify(ocraParams, response, UINT64_MAX).offset, ocra::Ocra::MAX_WINDOW);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailVerifyWithoutCounterValue)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+
+    ASSERT_THROW_MESSAGE(ocra.Verify(ocraParams, "12345678", 10u),
+                         "OCRA operator() failed, suite contains a counter, but no counter value in parameters");
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(ocra.Verify(ocraParams, "12345678", 10u).status, 0x12);
+    #endif
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailVerifyOfSuiteWithoutTimestamp)
+{
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.counter = 1u;
+    const auto clock = mock::Clock{1234567890u};
+
+    ASSERT_THROW_MESSAGE(ocra.Verify(ocraParams, "12345678", clock, 2u),
+                         "OCRA Verify() failed, suite does not contain a timestamp with non-zero time-step");
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(ocra.Verify(ocraParams, "12345678", clock, 2u).status, 0x22);
+    #endif
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnPasswordDigestOfOtherSize)
+{
+    auto ocraSuite = "OCRA-1:HOTP-SHA256-8:QN08-PSHA256";
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.passwordDigest = std::vector<uint8_t>(20u);
+
+    ASSERT_THROW_MESSAGE(Get(std::move(ocraSuite), std::move(ocraParams)),
+                         "OCRA operator() failed, password digest size does not match the suite password hash");
+    ASSERT_RETURN_STATUS(Get(std::move(ocraSuite), std::move(ocraParams)), 0x23);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnTooLongQuestionBytes)
+{
+    auto ocraSuite = "OCRA-1:HOTP-SHA256-8:QH64";
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.questionBytes = std::vector<uint8_t>(129u);
+
+    ASSERT_THROW_MESSAGE(Get(std::move(ocraSuite), std::move(ocraParams)),
+                         "OCRA operator() failed, question bytes are longer than 128 bytes");
+    ASSERT_RETURN_STATUS(Get(std::move(ocraSuite), std::move(ocraParams)), 0x24);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnTooLongSessionInfoBytes)
+{
+    auto ocraSuite = "OCRA-1:HOTP-SHA256-8:QN08-S064";
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.sessionInfoBytes = std::vector<uint8_t>(65u);
+
+    ASSERT_THROW_MESSAGE(Get(std::move(ocraSuite), std::move(ocraParams)),
+                         "OCRA operator() failed, session info bytes are longer than the suite session length");
+    ASSERT_RETURN_STATUS(Get(std::move(ocraSuite), std::move(ocraParams)), 0x25);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldReportCodesWithoutThrowing)
+{
+    const auto invalid = ocra::Ocra::TryFrom("OCRA-1:HOTP-SHA1-6:QN65");
+    ASSERT_FALSE(invalid);
+    ASSERT_EQ(invalid.Error(), 0x09);
+
+    const auto valid = ocra::Ocra::TryFrom("ocra-1:hotp-sha256-8:c-qn08");
+    ASSERT_TRUE(valid);
+    ASSERT_EQ(valid.Value().Suite().to_string(), "OCRA-1:HOTP-SHA256-8:C-QN08");
+
+    const auto& ocra = valid.Value();
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.question = "1234567x";
+    ASSERT_EQ(ocra.TryCompute(ocraParams).status, 0x10);
+    ASSERT_EQ(ocra.TryCompute(ocraParams, ocra.Prepare({})).status, 0x10);
+
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    const auto key = ocra.Prepare(ocraParams.key);
+    ASSERT_EQ(ocra.TryCompute(ocraParams).status, 0x12);
+    ASSERT_EQ(ocra.TryVerify(ocraParams, "12345678", 10u).status, 0x12);
+
+    ocraParams.counter = 1u;
+    ASSERT_EQ(ocra.TryCompute(ocraParams, key).status, 0x15);
+    ASSERT_EQ(ocra.TryVerify(ocraParams, "12345678", 10u).status, 0x15);
+    ASSERT_EQ(ocra.TryVerify(ocraParams, "12345678", mock::Clock{}, 1u).status, 0x22);
+
+    ocraParams.question = "12345678";
+    ASSERT_TRUE(ocra.TryCompute(ocraParams, key));
+    ASSERT_EQ(ocra.TryCompute(ocraParams, key).View(), ocra.TryCompute(ocraParams).View());
+    ASSERT_EQ(ocra.TryVerify(ocraParams, ocra.TryCompute(ocraParams).View(), 10u).status, 0);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnTooLongQuestion)
+{
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = std::string(129u, 'a');
+
+    ASSERT_THROW_MESSAGE(Get("OCRA-1:HOTP-SHA256-8:QA64", ocraParams),
+                         "OCRA operator() failed, question is longer than the 128 bytes of the challenge");
+    ASSERT_RETURN_STATUS(Get("OCRA-1:HOTP-SHA256-8:QA64", ocraParams), 0x26);
+
+    ocraParams.question = std::string(257u, 'a');
+    ASSERT_RETURN_STATUS(Get("OCRA-1:HOTP-SHA256-8:QH64", ocraParams), 0x26);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldFailOnTooLongSessionInfo)
+{
+    auto ocraSuite = "OCRA-1:HOTP-SHA256-8:QN08-S064";
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.sessionInfo = std::string(129u, 'a');
+
+    ASSERT_THROW_MESSAGE(Get(std::move(ocraSuite), std::move(ocraParams)),
+                         "OCRA operator() failed, session info is longer than twice the suite session length");
+    ASSERT_RETURN_STATUS(Get(std::move(ocraSuite), std::move(ocraParams)), 0x27);
+}
+
+TEST_F(OcraFailureTestFixture, ShouldRejectInputsBeforeHashing)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08-PSHA1-S064");
+    auto ocraParams = ocra::OcraParameters{};
+    ocraParams.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    ocraParams.question = "12345678";
+    ocraParams.password = "1234";
+    ocraParams.sessionInfo = std::string(64u, 'a') + "x";
+    mock::OcraHashFunction().SetAvailableShaAlgorithm({ocra::OcraSha::SHA1});
+
+    // Both are rejected by the input checks, the counter does not grow for computed codes
+    const auto rejected = ocra::RejectedRequests();
+    ASSERT_EQ(ocra.TryCompute(ocraParams).status, 0x1A);
+    ocraParams.sessionInfo = std::string(64u, 'a');
+    ocraParams.question = "1234567x";
+    ASSERT_EQ(ocra.TryCompute(ocraParams).status, 0x15);
+    ASSERT_EQ(ocra::RejectedRequests(), rejected + 2u);
+
+    ocraParams.question = "12345678";
+    ASSERT_TRUE(ocra.TryCompute(ocraParams));
+    ASSERT_EQ(ocra::RejectedRequests(), rejected + 2u);
+}
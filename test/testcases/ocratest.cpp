@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <tuple>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/numeric.hpp"
 #include "ocra/ocra.hpp"
 #include "exception.hpp"
+#include "clock.hpp"
 #include "hashfunctions.hpp"
 
 
@@ -15,28 +21,7 @@ struct OcraTestParams
 class Params
 {
 public:
-    auto& AddKey(std::string value)
-    {
-        const int HexToInt[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-                                0, 0, 0, 0, 0, 0, 0,
-                                10, 11, 12, 13, 14, 15};
-        uint8_t v = 0;
-        for (auto i = 0u; i < value.size(); ++i)
-        {
-            const int c = toupper(value[i]) - '0';
-            if (c < 0 || (10 < c && c < 17) || c > 22)
-                return *this;
-            v <<= 4;
-            v |= HexToInt[c];
-
-            if (i % 2)
-            {
-                m_params.key.push_back(v);
-                v = 0;
-            }
-        }
-        return *this;
-    }
+    auto& AddKey(std::string value) { ocra::DecodeHex(value, m_params.key); return *this; }
     auto& AddCounter(uint64_t value) { m_params.counter = std::move(value); return *this; }
     auto& AddTimestamp(uint64_t value) { m_params.timestamp = std::move(value); return *this; }
     auto& AddPassword(std::string password) { m_params.password = std::move(password); return *this; }
@@ -175,4 +160,253 @@ TEST_P(OcraTest, ShouldGenerateProperValues)
 {
     std::string value = ocra::Ocra(GetParam().suite)(GetParam().parameters);
     ASSERT_EQ(value, GetParam().result);
-}
\ No newline at end of file
+}
+TEST_P(OcraTest, ShouldGenerateProperValuesWithPreparedKey)
+{
+    auto ocra = ocra::Ocra(GetParam().suite);
+    const auto key = ocra.Prepare(GetParam().parameters.key);
+    ASSERT_EQ(ocra(GetParam().parameters, key), GetParam().result);
+    ASSERT_EQ(ocra(GetParam().parameters, key), GetParam().result);
+}
+
+TEST_P(OcraTest, ShouldComputeProperValuesIntoFixedBuffer)
+{
+    const auto ocra = ocra::Ocra(GetParam().suite);
+    const auto key = ocra.Prepare(GetParam().parameters.key);
+    const auto result = ocra.Compute(GetParam().parameters, key);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result.View(), GetParam().result);
+    ASSERT_EQ(result.value[result.length], '\0');
+}
+
+TEST_P(OcraTest, ShouldComputeProperValuesInBatch)
+{
+    auto ocra = ocra::Ocra(GetParam().suite);
+    auto parameters = std::vector<ocra::OcraParameters>(2 * ocra::hash::MAX_LANES + 5u, GetParam().parameters);
+    for (auto i = 1u; i < parameters.size(); ++i)
+        parameters[i].key.resize(parameters[i].key.size() + 3u * i, static_cast<uint8_t>(i));
+
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra.Compute(parameters, results), parameters.size());
+    ASSERT_EQ(results[0].View(), GetParam().result);
+    for (auto i = 1u; i < parameters.size(); ++i)
+        ASSERT_EQ(results[i].View(), ocra(parameters[i]));
+}
+
+TEST_P(OcraTest, ShouldComputeProperValuesFromView)
+{
+    // All the fields in one buffer, as a request decoder would have them
+    const auto& parameters = GetParam().parameters;
+    auto buffer = std::string(parameters.key.begin(), parameters.key.end());
+    const auto append = [&buffer](const auto& value)
+    {
+        const auto offset = buffer.size();
+        if (value)
+            buffer += *value;
+        return std::make_pair(offset, value ? value->size() : 0u);
+    };
+    const auto question = append(parameters.question);
+    const auto password = append(parameters.password);
+
+    auto view = ocra::OcraParametersView{};
+    view.key = {reinterpret_cast<const uint8_t*>(buffer.data()), parameters.key.size()};
+    view.counter = parameters.counter;
+    view.timestamp = parameters.timestamp;
+    view.question = std::string_view(buffer).substr(question.first, question.second);
+    if (parameters.password)
+        view.password = std::string_view(buffer).substr(password.first, password.second);
+
+    auto ocra = ocra::Ocra(GetParam().suite);
+    ASSERT_EQ(ocra(view), GetParam().result);
+    ASSERT_EQ(ocra(view, ocra.Prepare(view.key)), GetParam().result);
+    ASSERT_EQ(ocra.Compute(view).View(), GetParam().result);
+
+    const ocra::OcraParametersView views[] = {view, parameters, view};
+    ocra::OtpResult results[3];
+    ASSERT_EQ(ocra.Compute(views, results), 3u);
+    for (const auto& result : results)
+        ASSERT_EQ(result.View(), GetParam().result);
+}
+
+TEST_P(OcraTest, ShouldComputeProperValuesFromBinaryInputs)
+{
+    auto ocra = ocra::Ocra(GetParam().suite);
+    auto parameters = GetParam().parameters;
+
+    // The challenge block as the text one is encoded
+    const auto& question = *parameters.question;
+    auto bytes = std::vector<uint8_t>(ocra::EvaluationPlan::QUESTION_LENGTH);
+    if (ocra.Suite().challenge.format == 'N')
+        bytes.resize(ocra::EncodeNumericQuestion(question, bytes.data(), bytes.size()));
+    else
+        bytes.assign(question.begin(), question.end());
+    parameters.questionBytes = bytes;
+    parameters.question = "not used";
+
+    if (parameters.password)
+    {
+        parameters.passwordDigest = std::vector<uint8_t>(ocra.Plan().passwordLength);
+        ocra::hash::Digest(static_cast<ocra::hash::Algorithm>(ocra.Suite().passwordSha),
+                           reinterpret_cast<const uint8_t*>(parameters.password->data()),
+                           parameters.password->size(), parameters.passwordDigest->data());
+        parameters.password.reset();
+    }
+
+    ASSERT_EQ(ocra.Compute(parameters, ocra.Prepare(parameters.key)).View(), GetParam().result);
+    ASSERT_EQ(ocra.Compute(parameters).View(), GetParam().result);
+}
+
+TEST(OcraBinarySessionTest, ShouldComputeSessionBytesAsDecodedSessionInfo)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA256});
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08-S064");
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930313233343536373839303132", parameters.key);
+    parameters.question = "12345678";
+    parameters.sessionInfo = "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF";
+    const auto expected = ocra.Compute(parameters);
+
+    auto bytes = std::vector<uint8_t>{};
+    ocra::DecodeHex(*parameters.sessionInfo, bytes);
+    parameters.sessionInfo.reset();
+    parameters.sessionInfoBytes = bytes;
+    ASSERT_EQ(ocra.Compute(parameters).View(), expected.View());
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
+
+TEST(OcraBinarySessionTest, ShouldKeepOddSessionInfoInsideItsField)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA1});
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930", parameters.key);
+    parameters.question = "12345678";
+
+    for (const auto& [suite, sessionInfo, bytes] : {
+        std::make_tuple("OCRA-1:HOTP-SHA1-6:QN08-S001", "A", std::vector<uint8_t>{0x0A}),
+        std::make_tuple("OCRA-1:HOTP-SHA1-6:QN08-S003", "ABC", std::vector<uint8_t>{0x00, 0xAB, 0xC0}),
+        std::make_tuple("OCRA-1:HOTP-SHA1-6:QN08-S003", "ABCDEF", std::vector<uint8_t>{0x00, 0xAB, 0xC0})})
+    {
+        const auto ocra = ocra::Ocra(suite);
+        parameters.sessionInfo = sessionInfo;
+        parameters.sessionInfoBytes.reset();
+        const auto result = ocra.Compute(parameters);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(ocra.Compute(parameters, ocra.Prepare(parameters.key)).View(), result.View());
+
+        parameters.sessionInfo.reset();
+        parameters.sessionInfoBytes = bytes;
+        ASSERT_EQ(ocra.Compute(parameters).View(), result.View());
+    }
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
+
+TEST(OcraBinarySessionTest, ShouldTellSingleSessionCharactersApart)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA1});
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-8:QN08-S001");
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex("3132333435363738393031323334353637383930", parameters.key);
+    parameters.question = "12345678";
+
+    parameters.sessionInfo = "A";
+    const auto first = ocra.Compute(parameters);
+    parameters.sessionInfo = "B";
+    const auto second = ocra.Compute(parameters);
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    ASSERT_NE(first.View(), second.View());
+    ASSERT_EQ(ocra.Compute(parameters, ocra.Prepare(parameters.key)).View(), second.View());
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
+
+TEST_P(OcraTest, ShouldVerifyResponseWithinCounterWindow)
+{
+    const auto ocra = ocra::Ocra(GetParam().suite);
+    if (!ocra.Suite().isCounter)
+        return;
+
+    const auto counter = *GetParam().parameters.counter;
+    for (const auto distance : {0u, 1u, 3u, 17u, 40u})
+    {
+        if (counter < distance)
+            continue;
+
+        auto parameters = GetParam().parameters;
+        parameters.counter = counter - distance;
+        const auto result = ocra.Verify(parameters, GetParam().result, 40u);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result.offset, distance);
+        ASSERT_TRUE(ocra.Verify(parameters, GetParam().result, distance));
+        if (distance)
+        {
+            ASSERT_FALSE(ocra.Verify(parameters, GetParam().result, distance - 1u));
+        }
+    }
+
+    ASSERT_FALSE(ocra.Verify(GetParam().parameters, "0", 20u));
+}
+
+TEST_P(OcraTest, ShouldVerifyResponseWithinTimeDrift)
+{
+    const auto ocra = ocra::Ocra(GetParam().suite);
+    const auto seconds = ocra.Suite().timestamp.Seconds();
+    if (!seconds)
+        return;
+
+    const auto timestamp = *GetParam().parameters.timestamp;
+    auto clock = mock::Clock{};
+    for (const auto drift : {-3, -1, 0, 2, 3})
+    {
+        clock.Set((timestamp - drift) * seconds + seconds / 2u);
+        const auto result = ocra.Verify(GetParam().parameters, GetParam().result, clock, 3u);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result.drift, drift);
+    }
+
+    auto parameters = GetParam().parameters;
+    parameters.timestamp.reset();
+    clock.Set((timestamp + 4u) * seconds);
+    ASSERT_FALSE(ocra.Verify(parameters, GetParam().result, clock, 3u));
+    ASSERT_EQ(ocra.Verify(parameters, GetParam().result, clock, 4u).drift, -4);
+    clock.Set(timestamp * seconds);
+    ASSERT_TRUE(ocra.Verify(parameters, GetParam().result, clock, 0u));
+
+    // A drift over the whole step range is limited, not wrapped to no step at all
+    ASSERT_TRUE(ocra.Verify(parameters, GetParam().result, clock, UINT64_MAX));
+    clock.Set((timestamp + ocra::Ocra::MAX_DRIFT + 1u) * seconds);
+    ASSERT_FALSE(ocra.Verify(parameters, GetParam().result, clock, UINT64_MAX));
+}
+
+TEST_P(OcraTest, ShouldGenerateProperValuesWithKeyPreparedOutsideSuite)
+{
+    auto ocra = ocra::Ocra(GetParam().suite);
+    const auto key = ocra::PreparedKey(GetParam().parameters.key, ocra.Suite().hmac);
+    ASSERT_EQ(ocra(GetParam().parameters, key), GetParam().result);
+}
+
+TEST(OcraPreparedKeyTest, ShouldUsePrefixOnlyOfSamePlan)
+{
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>(20u, 0x31);
+    parameters.question = "12345678";
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    const auto copy = ocra;
+    const auto key = ocra.Prepare(parameters.key);
+    const auto plain = ocra::PreparedKey(parameters.key, ocra::OcraHmac::HOTP_SHA1);
+    ASSERT_EQ(copy.Compute(parameters, key).View(), copy.Compute(parameters, plain).View());
+
+    // The prefix of the previous suite is not reused
+    ocra.From("OCRA-1:HOTP-SHA1-8:QN08");
+    ASSERT_EQ(ocra.Compute(parameters, key).View(), ocra.Compute(parameters, plain).View());
+    ASSERT_EQ(ocra.Compute(parameters, key).length, 8u);
+}
+
+TEST(OcraNoTruncationTest, ShouldGenerateValueAsRfcReferenceForZeroDigits)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA1});
+    const ocra::OcraParameters parameters = Params().AddKey("3132333435363738393031323334353637383930").AddChallenge("00000000");
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-0:QN08");
+    ASSERT_EQ(ocra(parameters), "0");
+    ASSERT_EQ(ocra.Compute(parameters, ocra.Prepare(parameters.key)).View(), "0");
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
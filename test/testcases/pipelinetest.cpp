@@ -0,0 +1,347 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ocra/ocra.hpp"
+#include "ocra/provider.hpp"
+#include "runtime/pipeline.hpp"
+#include "runtime/queue.hpp"
+#include "hashfunctions.hpp"
+
+
+TEST(BoundedQueueTest, ShouldRoundCapacityUpToPowerOfTwo)
+{
+    ASSERT_EQ(ocra::runtime::BoundedQueue<int>(0u).Capacity(), 2u);
+    ASSERT_EQ(ocra::runtime::BoundedQueue<int>(5u).Capacity(), 8u);
+    ASSERT_EQ(ocra::runtime::BoundedQueue<int>(64u).Capacity(), 64u);
+}
+
+TEST(BoundedQueueTest, ShouldRefuseValueWhenFull)
+{
+    auto queue = ocra::runtime::BoundedQueue<int>(4u);
+    for (auto i = 0; i < 4; ++i)
+        ASSERT_TRUE(queue.TryPush(i));
+    ASSERT_FALSE(queue.TryPush(4));
+    ASSERT_EQ(queue.Size(), 4u);
+
+    // First in, first out, also after wrapping around
+    auto value = 0;
+    for (auto lap = 0; lap < 3; ++lap)
+    {
+        for (auto i = 0; i < 4; ++i)
+        {
+            ASSERT_TRUE(queue.TryPop(value));
+            ASSERT_EQ(value, 4 * lap + i);
+        }
+        ASSERT_FALSE(queue.TryPop(value));
+        for (auto i = 0; i < 4; ++i)
+            ASSERT_TRUE(queue.TryPush(4 * (lap + 1) + i));
+    }
+}
+
+TEST(BoundedQueueTest, ShouldPassEveryValueOnceBetweenThreads)
+{
+    constexpr auto PRODUCERS = 3u;
+    constexpr auto VALUES = 20000u;
+    auto queue = ocra::runtime::BoundedQueue<uint32_t>(16u);
+    auto received = std::vector<std::atomic<int>>(PRODUCERS * VALUES);
+    auto remaining = std::atomic<uint32_t>{PRODUCERS * VALUES};
+
+    auto threads = std::vector<std::thread>{};
+    for (auto p = 0u; p < PRODUCERS; ++p)
+    {
+        threads.emplace_back([&, p]() {
+            for (auto i = 0u; i < VALUES; ++i)
+                while (!queue.TryPush(p * VALUES + i))
+                    std::this_thread::yield();
+        });
+        threads.emplace_back([&]() {
+            auto value = uint32_t{};
+            while (remaining.load() > 0u)
+            {
+                if (queue.TryPop(value))
+                {
+                    received[value].fetch_add(1);
+                    remaining.fetch_sub(1u);
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto i = 0u; i < received.size(); ++i)
+        ASSERT_EQ(received[i].load(), 1) << "value " << i;
+}
+
+
+class PipelineTest : public ::testing::TestWithParam<const char*>
+{
+public:
+    // Own key for every request, a part of them fails by the input checks
+    static std::vector<ocra::OcraParameters> Requests(const ocra::Ocra& ocra, std::size_t count)
+    {
+        auto parameters = std::vector<ocra::OcraParameters>(count);
+        for (auto i = 0u; i < count; ++i)
+        {
+            parameters[i].key = std::vector<uint8_t>{0x31, 0x32, static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)};
+            parameters[i].counter = i;
+            parameters[i].timestamp = 0x132d0b6 + i;
+            parameters[i].password = "1234";
+            parameters[i].question = ocra.Suite().challenge.format == 'A' ? "SIG" + std::to_string(i)
+                                                                           : std::to_string(10000000u + i);
+            if (i % 97u == 5u)
+                parameters[i].question = "3215j";
+            if (i % 89u == 7u)
+                parameters[i].key.clear();
+        }
+        return parameters;
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, PipelineTest, ::testing::Values(
+    "OCRA-1:HOTP-SHA1-6:QN08",
+    "OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1",
+    "OCRA-1:HOTP-SHA512-8:QA10-T1M",
+    "OCRA-1:HOTP-SHA512-0:QN08"
+));
+
+TEST_P(PipelineTest, ShouldComputeAsBatchForManyProducers)
+{
+    constexpr auto PRODUCERS = 4u;
+    const auto ocra = ocra::Ocra(GetParam());
+    const auto parameters = Requests(ocra, 2000u);
+    auto expected = std::vector<ocra::OtpResult>(parameters.size());
+    ocra.Compute(parameters, expected);
+
+    // Small queues, the producers meet the backpressure
+    auto pipeline = ocra::runtime::Pipeline(ocra, 8u);
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(parameters.size());
+    auto producers = std::vector<std::thread>{};
+    for (auto p = 0u; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (auto i = p; i < requests.size(); i += PRODUCERS)
+            {
+                requests[i].parameters = parameters[i];
+                while (!pipeline.TrySubmit(requests[i]))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& producer : producers)
+        producer.join();
+
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        while (!requests[i].IsDone())
+            std::this_thread::yield();
+        ASSERT_EQ(requests[i].result.status, expected[i].status) << "request " << i;
+        ASSERT_EQ(requests[i].result.View(), expected[i].View()) << "request " << i;
+    }
+
+    const auto statistics = pipeline.Statistics();
+    ASSERT_EQ(statistics.submitted, parameters.size());
+    ASSERT_EQ(statistics.failed + statistics.hashed, parameters.size());
+    ASSERT_GE(statistics.batches, 1u);
+    ASSERT_LE(statistics.batches, statistics.hashed);
+}
+
+TEST(PipelineFailureTest, ShouldReportCodesOfInvalidRequests)
+{
+    auto pipeline = ocra::runtime::Pipeline(ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08"));
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    parameters.question = "12345678";
+
+    auto request = ocra::runtime::PipelineRequest{};
+    request.parameters = parameters;
+    ASSERT_TRUE(pipeline.TrySubmit(request));
+    while (!request.IsDone())
+        std::this_thread::yield();
+    ASSERT_EQ(request.result.status, 0x12);
+    ASSERT_EQ(pipeline.Statistics().failed, 1u);
+}
+
+TEST(PipelineFailureTest, ShouldFinishSubmittedRequestsWhenDestroyed)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>(20u, 0x31);
+    parameters.question = "00000000";
+
+    auto done = std::atomic<int>{};
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(100u);
+    {
+        auto pipeline = ocra::runtime::Pipeline(ocra, 128u);
+        for (auto& request : requests)
+        {
+            request.parameters = parameters;
+            request.context = &done;
+            request.done = [](ocra::runtime::PipelineRequest& request) {
+                static_cast<std::atomic<int>*>(request.context)->fetch_add(1);
+            };
+            ASSERT_TRUE(pipeline.TrySubmit(request));
+        }
+    }
+
+    ASSERT_EQ(done.load(), 100);
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA1});
+    for (const auto& request : requests)
+    {
+        ASSERT_FALSE(request.IsDone());
+        ASSERT_EQ(request.result.View(), ocra.Compute(parameters).View());
+    }
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
+
+TEST(PipelineIdleTest, ShouldWakeSleepingStagesForNextRequest)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    auto pipeline = ocra::runtime::Pipeline(ocra, 2u);
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(20u);
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>{0x1, 0xff, 0x4};
+    parameters.question = "12345678";
+    parameters.counter = 1u;
+    const auto expected = ocra.TryCompute(parameters, ocra.Prepare(parameters.key));
+
+    // Idle between the requests, every stage sleeps in the meantime
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        if (i % 5u == 0u)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        requests[i].parameters = parameters;
+        while (!pipeline.TrySubmit(requests[i]))
+            std::this_thread::yield();
+    }
+    for (const auto& request : requests)
+    {
+        while (!request.IsDone())
+            std::this_thread::yield();
+        ASSERT_EQ(request.result.status, 0);
+        ASSERT_EQ(request.result.View(), expected.View());
+    }
+}
+
+TEST(PipelineProviderTest, ShouldHashWithRegisteredBatchFunction)
+{
+    static auto calls = std::atomic<int>{};
+    static auto isFailing = std::atomic<bool>{};
+    ocra::RegisterHmacBatch([](std::size_t count, const ocra::HmacRequest* requests, const ocra::Span<uint8_t>* digests) {
+        ++calls;
+        for (auto i = 0u; i < count; ++i)
+        {
+            const auto algorithm = static_cast<ocra::hash::Algorithm>(requests[i].hmac);
+            auto context = ocra::hash::HmacContext(algorithm, requests[i].key.data(), requests[i].key.size());
+            context.Update(requests[i].message.data(), requests[i].message.size());
+            context.Final(digests[i].data());
+        }
+        return !isFailing.load();
+    });
+
+    // The batch hashes the password by the user function too
+    mock::OcraHashFunction().SetAvailableShaAlgorithm({ocra::OcraSha::SHA1});
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1");
+    const auto parameters = PipelineTest::Requests(ocra, 300u);
+    auto expected = std::vector<ocra::OtpResult>(parameters.size());
+    ocra.Compute(parameters, expected);
+    const auto computeCalls = calls.load();
+    ASSERT_GT(computeCalls, 0);
+
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(parameters.size());
+    {
+        auto pipeline = ocra::runtime::Pipeline(ocra);
+        for (auto i = 0u; i < requests.size(); ++i)
+        {
+            requests[i].parameters = parameters[i];
+            while (!pipeline.TrySubmit(requests[i]))
+                std::this_thread::yield();
+        }
+        for (auto& request : requests)
+            while (!request.IsDone())
+                std::this_thread::yield();
+    }
+    ASSERT_GT(calls.load(), computeCalls);
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        ASSERT_EQ(requests[i].result.status, expected[i].status) << "request " << i;
+        ASSERT_EQ(requests[i].result.View(), expected[i].View()) << "request " << i;
+    }
+
+    isFailing = true;
+    {
+        auto pipeline = ocra::runtime::Pipeline(ocra);
+        requests[0].parameters = parameters[0];
+        ASSERT_TRUE(pipeline.TrySubmit(requests[0]));
+        while (!requests[0].IsDone())
+            std::this_thread::yield();
+    }
+    ASSERT_EQ(requests[0].result.status, 0x11);
+    ocra::RegisterHmacBatch(nullptr);
+    mock::OcraHashFunction().SetAvailableShaAlgorithm({});
+}
+
+TEST(PipelineProviderTest, ShouldHashWithRegisteredStreamingProvider)
+{
+    // Forwards to the built-in engine and counts the messages
+    class CountingProvider : public ocra::HashProvider
+    {
+    public:
+        bool Init(State& state, ocra::Span<const uint8_t> key) const override
+        {
+            return m_provider.Init(state, key);
+        }
+
+        void Update(State& state, ocra::Span<const uint8_t> data) const override
+        {
+            m_provider.Update(state, data);
+        }
+
+        bool Final(State& state, ocra::Span<uint8_t> digest) const override
+        {
+            ++finals;
+            return m_provider.Final(state, digest);
+        }
+
+        mutable std::atomic<int> finals{};
+
+    private:
+        const ocra::HashProvider& m_provider = ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA256);
+    };
+
+    const auto provider = CountingProvider();
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, &provider);
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    const auto parameters = PipelineTest::Requests(ocra, 100u);
+
+    auto requests = std::vector<ocra::runtime::PipelineRequest>(parameters.size());
+    {
+        auto pipeline = ocra::runtime::Pipeline(ocra);
+        for (auto i = 0u; i < requests.size(); ++i)
+        {
+            requests[i].parameters = parameters[i];
+            while (!pipeline.TrySubmit(requests[i]))
+                std::this_thread::yield();
+        }
+        for (auto& request : requests)
+            while (!request.IsDone())
+                std::this_thread::yield();
+    }
+
+    const auto hashed = provider.finals.load();
+    ASSERT_GT(hashed, 0);
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        const auto expected = ocra.TryCompute(parameters[i]);
+        ASSERT_EQ(requests[i].result.status, expected.status) << "request " << i;
+        ASSERT_EQ(requests[i].result.View(), expected.View()) << "request " << i;
+    }
+    ASSERT_EQ(provider.finals.load(), 2 * hashed);
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, nullptr);
+}
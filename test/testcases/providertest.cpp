@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/ocra.hpp"
+#include "ocra/provider.hpp"
+#include "exception.hpp"
+#include "hashfunctions.hpp"
+
+
+namespace
+{
+constexpr auto _32_BYTES_KEY = "3132333435363738393031323334353637383930313233343536373839303132";
+
+// Forwards to the built-in engine and counts the calls
+class CountingProvider : public ocra::HashProvider
+{
+public:
+    explicit CountingProvider(const ocra::HashProvider& provider) : m_provider(provider) {}
+
+    bool Init(State& state, ocra::Span<const uint8_t> key) const override
+    {
+        ++inits;
+        return m_provider.Init(state, key);
+    }
+
+    void Update(State& state, ocra::Span<const uint8_t> data) const override
+    {
+        ++updates;
+        m_provider.Update(state, data);
+    }
+
+    bool Final(State& state, ocra::Span<uint8_t> digest) const override
+    {
+        ++finals;
+        return m_provider.Final(state, digest);
+    }
+
+    mutable std::atomic<int> inits{};
+    mutable std::atomic<int> updates{};
+    mutable std::atomic<int> finals{};
+
+private:
+    const ocra::HashProvider& m_provider;
+};
+
+// Stand-in of a signing module, hashes a whole batch in one call
+struct BatchSigner
+{
+    static bool Sign(std::size_t count, const ocra::HmacRequest* requests, const ocra::Span<uint8_t>* digests)
+    {
+        ++calls;
+        messages += static_cast<int>(count);
+        for (auto i = 0u; i < count; ++i)
+        {
+            const auto algorithm = static_cast<ocra::hash::Algorithm>(requests[i].hmac);
+            auto context = ocra::hash::HmacContext(algorithm, requests[i].key.data(), requests[i].key.size());
+            context.Update(requests[i].message.data(), requests[i].message.size());
+            context.Final(digests[i].data());
+        }
+        return !isFailing;
+    }
+
+    inline static int calls{};
+    inline static int messages{};
+    inline static bool isFailing{};
+};
+
+ocra::OcraParameters Parameters(std::string question)
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex(_32_BYTES_KEY, parameters.key);
+    parameters.question = std::move(question);
+    return parameters;
+}
+}  // namespace
+
+
+class ProviderTestFixture : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+        mock::OcraHashFunction().SetAvailableShaAlgorithm({});
+    }
+
+    void TearDown() override
+    {
+        ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, nullptr);
+        ocra::RegisterProvider(ocra::OcraSha::SHA1, nullptr);
+        ocra::RegisterHmacBatch(nullptr);
+    }
+
+    auto Get(std::string suite, ocra::OcraParameters params)
+    {
+        auto ocra = ocra::Ocra(std::move(suite));
+        ocra(std::move(params));
+        return ocra;
+    }
+};
+
+
+TEST_F(ProviderTestFixture, ShouldUseUserFunctionsByDefault)
+{
+    ASSERT_EQ(&ocra::Provider(ocra::OcraHmac::HOTP_SHA256), &ocra::UserFunctionProvider(ocra::OcraHmac::HOTP_SHA256));
+    ASSERT_EQ(&ocra::Provider(ocra::OcraSha::SHA1), &ocra::UserFunctionProvider(ocra::OcraSha::SHA1));
+}
+
+TEST_F(ProviderTestFixture, ShouldComputeWithRegisteredProvider)
+{
+    const auto hmac = CountingProvider(ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA256));
+    const auto sha = CountingProvider(ocra::BuiltinProvider(ocra::OcraSha::SHA1));
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, &hmac);
+    ocra::RegisterProvider(ocra::OcraSha::SHA1, &sha);
+    ASSERT_EQ(&ocra::Provider(ocra::OcraHmac::HOTP_SHA256), &hmac);
+
+    auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1");
+    auto parameters = Parameters("12345678");
+    parameters.password = "1234";
+    parameters.counter = 9u;
+    ASSERT_EQ(ocra(parameters), "08522129");
+
+    // The suite prefix and the variable part are two pieces of one message
+    ASSERT_EQ(hmac.inits, 1);
+    ASSERT_EQ(hmac.updates, 2);
+    ASSERT_EQ(hmac.finals, 1);
+    ASSERT_EQ(sha.finals, 1);
+
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, nullptr);
+    ASSERT_EQ(&ocra::Provider(ocra::OcraHmac::HOTP_SHA256), &ocra::UserFunctionProvider(ocra::OcraHmac::HOTP_SHA256));
+}
+
+TEST_F(ProviderTestFixture, ShouldComputeBatchOneByOne)
+{
+    const auto& provider = ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA1);
+    const auto key = std::vector<uint8_t>(20u, 0x0b);
+    const auto data = std::string("Hi There");
+
+    const ocra::Span<const uint8_t> keys[2] = {{key.data(), key.size()}, {key.data(), key.size()}};
+    const ocra::Span<const uint8_t> messages[2] = {
+        {reinterpret_cast<const uint8_t*>(data.data()), data.size()},
+        {reinterpret_cast<const uint8_t*>(data.data()), 2u}};
+    uint8_t digests[2][20] = {};
+    const ocra::Span<uint8_t> outputs[2] = {{digests[0], 20u}, {digests[1], 20u}};
+    ASSERT_TRUE(provider.Batch(2u, keys, messages, outputs));
+
+    // RFC2202, test case 1
+    auto expected = std::vector<uint8_t>{};
+    ocra::DecodeHex("b617318655057264e28bc0b6fb378c8ef146be00", expected);
+    ASSERT_EQ(std::vector<uint8_t>(digests[0], digests[0] + 20), expected);
+
+    ocra::HashProvider::State state;
+    provider.Init(state, keys[1]);
+    provider.Update(state, messages[1]);
+    uint8_t digest[20] = {};
+    ASSERT_TRUE(provider.Final(state, {digest, 20u}));
+    ASSERT_EQ(std::string(digest, digest + 20), std::string(digests[1], digests[1] + 20));
+
+    // A digest span of another size is a failure
+    provider.Init(state, keys[0]);
+    ASSERT_FALSE(provider.Final(state, {digest, 19u}));
+}
+
+TEST_F(ProviderTestFixture, ShouldFailWhenUserFunctionsAreMissing)
+{
+    ASSERT_THROW_MESSAGE(Get("OCRA-1:HOTP-SHA256-8:QN08", Parameters("12345678")),
+                         "OCRA operator() failed, invalid HMAC result size, please check user defined HMACAlgorithm function");
+    ASSERT_RETURN_STATUS(Get("OCRA-1:HOTP-SHA256-8:QN08", Parameters("12345678")), 0x11);
+
+    auto parameters = Parameters("12345678");
+    parameters.password = "1234";
+    ASSERT_THROW_MESSAGE(Get("OCRA-1:HOTP-SHA256-8:QN08-PSHA256", parameters),
+                         "OCRA operator() failed, password hashing failed, check user defined ShaHashing function");
+    ASSERT_RETURN_STATUS(Get("OCRA-1:HOTP-SHA256-8:QN08-PSHA256", parameters), 0x17);
+}
+
+class ProviderBatchTest : public ProviderTestFixture
+{
+public:
+    void SetUp() override
+    {
+        ProviderTestFixture::SetUp();
+        BatchSigner::calls = 0;
+        BatchSigner::messages = 0;
+        BatchSigner::isFailing = false;
+
+        parameters.resize(150u);
+        for (auto i = 0u; i < parameters.size(); ++i)
+        {
+            parameters[i] = Parameters("12345678");
+            parameters[i].key.push_back(static_cast<uint8_t>(i));
+            parameters[i].counter = i;
+        }
+        parameters[5].key.clear();
+        parameters[9].question = "3215j";
+    }
+
+    void ExpectComputed(const std::vector<ocra::OtpResult>& results) const
+    {
+        for (auto i = 0u; i < parameters.size(); ++i)
+        {
+            const auto expected = ocra.TryCompute(parameters[i], ocra.Prepare(parameters[i].key));
+            ASSERT_EQ(results[i].status, expected.status) << "request " << i;
+            ASSERT_EQ(results[i].View(), expected.View()) << "request " << i;
+        }
+    }
+
+public:
+    ocra::Ocra ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    std::vector<ocra::OcraParameters> parameters;
+};
+
+TEST_F(ProviderBatchTest, ShouldHashChunksInOneBatchCall)
+{
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra(parameters, results), parameters.size() - 2u);
+    ExpectComputed(results);
+    ASSERT_EQ(results[5].status, 0x10);
+    ASSERT_EQ(results[9].status, 0x15);
+
+    // Chunks of 64 messages, the failed requests are not sent
+    ASSERT_EQ(BatchSigner::calls, 3);
+    ASSERT_EQ(BatchSigner::messages, static_cast<int>(parameters.size()) - 2);
+}
+
+TEST_F(ProviderBatchTest, ShouldFallBackToHmacAlgorithmPerMessage)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA256});
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra(parameters, results), parameters.size() - 2u);
+    ExpectComputed(results);
+    ASSERT_EQ(BatchSigner::calls, 0);
+}
+
+TEST_F(ProviderBatchTest, ShouldUseBatchOfRegisteredProvider)
+{
+    const auto hmac = CountingProvider(ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA256));
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, &hmac);
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra(parameters, results), parameters.size() - 2u);
+    ExpectComputed(results);
+    ASSERT_EQ(hmac.finals, static_cast<int>(parameters.size()) - 2);
+    ASSERT_EQ(BatchSigner::calls, 0);
+}
+
+TEST_F(ProviderBatchTest, ShouldComputeAndVerifyWithRegisteredStreamingProvider)
+{
+    const auto hmac = CountingProvider(ocra::BuiltinProvider(ocra::OcraHmac::HOTP_SHA256));
+    const auto sha = CountingProvider(ocra::BuiltinProvider(ocra::OcraSha::SHA1));
+    ocra::RegisterProvider(ocra::OcraHmac::HOTP_SHA256, &hmac);
+    ocra::RegisterProvider(ocra::OcraSha::SHA1, &sha);
+    const auto pinOcra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1");
+    for (auto& request : parameters)
+        request.password = "1234";
+
+    // Neither the keys nor the passwords go to the built-in engine
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(pinOcra.Compute(parameters, results), parameters.size() - 2u);
+    ASSERT_EQ(hmac.finals, static_cast<int>(parameters.size()) - 2);
+    ASSERT_EQ(sha.finals, static_cast<int>(parameters.size()) - 2);
+    for (auto i = 0u; i < parameters.size(); ++i)
+    {
+        const auto expected = pinOcra.TryCompute(parameters[i]);
+        ASSERT_EQ(results[i].status, expected.status) << "request " << i;
+        ASSERT_EQ(results[i].View(), expected.View()) << "request " << i;
+    }
+
+    auto request = parameters[100];
+    request.counter = 0u;
+    const auto finals = hmac.finals.load();
+    const auto result = pinOcra.TryVerify(request, results[100].View(), 150u);
+    ASSERT_EQ(result.status, 0);
+    ASSERT_TRUE(result.isMatch);
+    ASSERT_EQ(result.offset, 100u);
+    ASSERT_EQ(hmac.finals - finals, 128);
+}
+
+TEST_F(ProviderBatchTest, ShouldFailChunkOfFailedBatchCall)
+{
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    BatchSigner::isFailing = true;
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra(parameters, results), 0u);
+    ASSERT_EQ(results[0].status, 0x11);
+    ASSERT_EQ(results[149].status, 0x11);
+    ASSERT_EQ(results[5].status, 0x10);
+    ASSERT_EQ(results[9].status, 0x15);
+
+    // Without the user functions every message fails alone
+    ocra::RegisterHmacBatch(nullptr);
+    ASSERT_EQ(ocra(parameters, results), 0u);
+    ASSERT_EQ(results[0].status, 0x11);
+}
+
+TEST_F(ProviderBatchTest, ShouldKeepOddSessionInfoOfEveryLane)
+{
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    for (const auto& [suite, sessionInfo] : {std::make_pair("OCRA-1:HOTP-SHA256-8:C-QN08-S001", "A"),
+                                             std::make_pair("OCRA-1:HOTP-SHA256-8:C-QN08-S003", "ABC")})
+    {
+        ocra = ocra::Ocra(suite);
+        for (auto& request : parameters)
+            request.sessionInfo = sessionInfo;
+
+        // The messages of a chunk are packed one after another, a lane never reaches the next one
+        auto results = std::vector<ocra::OtpResult>(parameters.size());
+        ASSERT_EQ(ocra(parameters, results), parameters.size() - 2u);
+        ExpectComputed(results);
+    }
+}
+
+TEST_F(ProviderBatchTest, ShouldSplitLongBatchOfUserFunction)
+{
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    const auto key = std::vector<uint8_t>(20u, 0x0b);
+    const auto data = std::string("Hi There");
+    auto keys = std::vector<ocra::Span<const uint8_t>>(100u, {key.data(), key.size()});
+    auto messages = std::vector<ocra::Span<const uint8_t>>(
+        100u, {reinterpret_cast<const uint8_t*>(data.data()), data.size()});
+    auto digests = std::vector<uint8_t>(100u * 20u);
+    auto outputs = std::vector<ocra::Span<uint8_t>>{};
+    for (auto i = 0u; i < 100u; ++i)
+        outputs.push_back({digests.data() + 20u * i, 20u});
+
+    const auto& provider = ocra::UserFunctionProvider(ocra::OcraHmac::HOTP_SHA1);
+    ASSERT_TRUE(provider.Batch(100u, keys.data(), messages.data(), outputs.data()));
+    ASSERT_EQ(BatchSigner::calls, 2);
+    ASSERT_EQ(BatchSigner::messages, 100);
+
+    // RFC2202, test case 1
+    auto expected = std::vector<uint8_t>{};
+    ocra::DecodeHex("b617318655057264e28bc0b6fb378c8ef146be00", expected);
+    ASSERT_EQ(std::vector<uint8_t>(digests.end() - 20, digests.end()), expected);
+}
+
+TEST_F(ProviderBatchTest, ShouldHashFewerMessagesPerCallOfLongSuite)
+{
+    // The characters past the terminating zero are a part of the message prefix too
+    const auto longOcra = ocra::Ocra(std::string("OCRA-1:HOTP-SHA256-8:C-QN08") + std::string(4000u, '\0'));
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(longOcra(parameters, results), parameters.size() - 2u);
+    for (auto i = 0u; i < parameters.size(); ++i)
+    {
+        const auto expected = longOcra.TryCompute(parameters[i], longOcra.Prepare(parameters[i].key));
+        ASSERT_EQ(results[i].status, expected.status) << "request " << i;
+        ASSERT_EQ(results[i].View(), expected.View()) << "request " << i;
+    }
+    ASSERT_GT(BatchSigner::calls, 3);
+    ASSERT_EQ(BatchSigner::messages, static_cast<int>(parameters.size()) - 2);
+
+    auto request = parameters[100];
+    request.counter = 0u;
+    const auto result = longOcra.TryVerify(request, results[100].View(), 150u);
+    ASSERT_TRUE(result.isMatch);
+    ASSERT_EQ(result.offset, 100u);
+}
+
+TEST_F(ProviderBatchTest, ShouldComputeBatchWithRegisteredFunction)
+{
+    auto expected = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra.Compute(parameters, expected), parameters.size() - 2u);
+    ASSERT_EQ(BatchSigner::calls, 0);
+
+    // The keys may be handles of the module now, the built-in engine does not get them
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+    ASSERT_EQ(ocra.Compute(parameters, results), parameters.size() - 2u);
+    ExpectComputed(results);
+    ASSERT_EQ(BatchSigner::calls, 3);
+    ASSERT_EQ(BatchSigner::messages, static_cast<int>(parameters.size()) - 2);
+}
+
+TEST_F(ProviderBatchTest, ShouldVerifyWithRegisteredFunction)
+{
+    const auto response = std::string(ocra.TryCompute(parameters[100], ocra.Prepare(parameters[100].key)).View());
+    auto request = parameters[100];
+    request.counter = 0u;
+
+    ocra::RegisterHmacBatch(BatchSigner::Sign);
+    const auto result = ocra.TryVerify(request, response, 150u);
+    ASSERT_EQ(result.status, 0);
+    ASSERT_TRUE(result.isMatch);
+    ASSERT_EQ(result.offset, 100u);
+    ASSERT_EQ(BatchSigner::calls, 2);
+
+    ASSERT_FALSE(ocra.TryVerify(request, response, 99u).isMatch);
+    BatchSigner::isFailing = true;
+    ASSERT_EQ(ocra.TryVerify(request, response, 150u).status, 0x11);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "ocra/ocra.hpp"
+#include "runtime/batch.hpp"
+#include "runtime/threadpool.hpp"
+#include "exception.hpp"
+
+
+struct ParallelForParameters
+{
+    std::size_t workers;
+    std::size_t count;
+    std::size_t grain;
+};
+
+class ThreadPoolTest : public ::testing::TestWithParam<ParallelForParameters>
+{};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, ThreadPoolTest, ::testing::Values(
+    ParallelForParameters{1u, 100u, 7u},
+    ParallelForParameters{2u, 0u, 1u},
+    ParallelForParameters{2u, 1u, 16u},
+    ParallelForParameters{3u, 1000u, 1u},
+    ParallelForParameters{4u, 10007u, 64u},
+    ParallelForParameters{8u, 5u, 1u},
+    ParallelForParameters{8u, 100000u, 256u}
+));
+
+TEST_P(ThreadPoolTest, ShouldRunEveryIndexOnce)
+{
+    auto pool = ocra::runtime::ThreadPool(GetParam().workers);
+    ASSERT_EQ(pool.Workers(), GetParam().workers);
+
+    // The same pool runs several jobs one after another
+    for (auto job = 0u; job < 3u; ++job)
+    {
+        auto runs = std::vector<std::atomic<int>>(GetParam().count);
+        pool.ParallelFor(GetParam().count, GetParam().grain,
+            [&](std::size_t begin, std::size_t end, std::size_t worker) {
+                ASSERT_LT(begin, end);
+                ASSERT_LE(end - begin, GetParam().grain);
+                ASSERT_LT(worker, GetParam().workers);
+                for (auto i = begin; i < end; ++i)
+                    runs[i].fetch_add(1, std::memory_order_relaxed);
+            });
+        for (auto i = 0u; i < runs.size(); ++i)
+            ASSERT_EQ(runs[i].load(), 1) << "index " << i;
+    }
+}
+
+TEST(ThreadPoolFailureTest, ShouldRethrowExceptionOfTask)
+{
+    auto pool = ocra::runtime::ThreadPool(4u);
+    ASSERT_THROW(pool.ParallelFor(1000u, 10u,
+                     [](std::size_t begin, std::size_t end, std::size_t) {
+                         if (begin <= 500u && 500u < end)
+                             throw std::runtime_error("task failed");
+                     }),
+                 std::runtime_error);
+
+    // Usable after the failure
+    auto count = std::atomic<std::size_t>{};
+    pool.ParallelFor(1000u, 10u, [&](std::size_t begin, std::size_t end, std::size_t) { count += end - begin; });
+    ASSERT_EQ(count.load(), 1000u);
+}
+
+TEST(ThreadPoolFailureTest, ShouldUseOneWorkerForZero)
+{
+    auto pool = ocra::runtime::ThreadPool(0u);
+    ASSERT_EQ(pool.Workers(), 1u);
+}
+
+
+class BatchEvaluatorTest : public ::testing::Test
+{
+public:
+    // Own key for every request, a part of them fails by the input checks
+    static std::vector<ocra::OcraParameters> Requests(std::size_t count)
+    {
+        auto parameters = std::vector<ocra::OcraParameters>(count);
+        for (auto i = 0u; i < count; ++i)
+        {
+            parameters[i].key = std::vector<uint8_t>{0x31, 0x32, static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)};
+            parameters[i].counter = i;
+            parameters[i].question = std::to_string(10000000u + i);
+            if (i % 97u == 5u)
+                parameters[i].question = "3215j";
+            if (i % 89u == 7u)
+                parameters[i].key.clear();
+        }
+        return parameters;
+    }
+};
+
+TEST_F(BatchEvaluatorTest, ShouldComputeAsSequentialBatch)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    const auto parameters = Requests(5000u);
+    auto expected = std::vector<ocra::OtpResult>(parameters.size());
+    const auto expectedCount = ocra.Compute(parameters, expected);
+
+    for (auto workers : {1u, 2u, 4u, 7u})
+    {
+        auto pool = ocra::runtime::ThreadPool(workers);
+        const auto evaluator = ocra::runtime::BatchEvaluator(pool, 50u);
+        auto results = std::vector<ocra::OtpResult>(parameters.size());
+        ASSERT_EQ(evaluator.Compute(ocra, parameters, results), expectedCount);
+        for (auto i = 0u; i < results.size(); ++i)
+        {
+            ASSERT_EQ(results[i].status, expected[i].status) << "request " << i;
+            ASSERT_EQ(results[i].View(), expected[i].View()) << "request " << i;
+        }
+    }
+    ASSERT_LT(expectedCount, parameters.size());
+    ASSERT_EQ(expected[5].status, 0x15);
+    ASSERT_EQ(expected[7].status, 0x10);
+}
+
+TEST_F(BatchEvaluatorTest, ShouldComputeViews)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08");
+    const auto parameters = Requests(1000u);
+    const auto views = std::vector<ocra::OcraParametersView>(parameters.begin(), parameters.end());
+    auto expected = std::vector<ocra::OtpResult>(parameters.size());
+    auto results = std::vector<ocra::OtpResult>(parameters.size());
+
+    auto pool = ocra::runtime::ThreadPool(3u);
+    ASSERT_EQ(ocra::runtime::BatchEvaluator(pool, 1u).Compute(ocra, views, results), ocra.Compute(views, expected));
+    for (auto i = 0u; i < results.size(); ++i)
+        ASSERT_EQ(results[i].View(), expected[i].View()) << "request " << i;
+}
+
+TEST_F(BatchEvaluatorTest, ShouldFailBatchWithTooFewResults)
+{
+    const auto ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:QN08");
+    const auto parameters = Requests(2000u);
+    auto results = std::vector<ocra::OtpResult>(parameters.size() - 1u);
+    auto pool = ocra::runtime::ThreadPool(2u);
+    const auto evaluator = ocra::runtime::BatchEvaluator(pool);
+
+    ASSERT_THROW_MESSAGE(evaluator.Compute(ocra, parameters, results),
+                         "OCRA Compute() failed, there are fewer results than parameters");
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(evaluator.Compute(ocra, parameters, results), 0u);
+    ASSERT_EQ(results[0].status, 0x20);
+    #endif
+}
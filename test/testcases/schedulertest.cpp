@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ocra/ocra.hpp"
+#include "runtime/scheduler.hpp"
+#include "hashfunctions.hpp"
+
+
+class BatchSchedulerTest : public ::testing::Test
+{
+public:
+    // Responses for the counter 'i + i % 5' of request 'i', a part of them wrong
+    void SetUp() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA256});
+        parameters.resize(200u);
+        responses.resize(parameters.size());
+        for (auto i = 0u; i < parameters.size(); ++i)
+        {
+            parameters[i].key = std::vector<uint8_t>{0x31, 0x32, static_cast<uint8_t>(i)};
+            parameters[i].question = "12345678";
+            parameters[i].counter = i + i % 5u;
+            responses[i] = i % 7u == 3u ? "00000000" : std::string(ocra.Compute(parameters[i]).View());
+            parameters[i].counter = i;
+        }
+        parameters[11].key.clear();
+        parameters[13].question = "3215j";
+    }
+
+    void TearDown() override
+    {
+        mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+    }
+
+    static void Wait(const ocra::runtime::VerifyRequest& request)
+    {
+        while (!request.IsDone())
+            std::this_thread::yield();
+    }
+
+public:
+    const ocra::Ocra ocra = ocra::Ocra("OCRA-1:HOTP-SHA256-8:C-QN08");
+    std::vector<ocra::OcraParameters> parameters;
+    std::vector<std::string> responses;
+};
+
+TEST_F(BatchSchedulerTest, ShouldVerifyAsOcra)
+{
+    auto options = ocra::runtime::SchedulerOptions{};
+    options.maxWait = std::chrono::microseconds(200);
+    auto scheduler = ocra::runtime::BatchScheduler(ocra, options);
+
+    // Windows above 'maxBatch' are verified apart from the batches
+    const uint64_t windows[] = {0u, 4u, 9u, 100u};
+    auto requests = std::vector<ocra::runtime::VerifyRequest>(parameters.size());
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        requests[i].parameters = parameters[i];
+        requests[i].response = responses[i];
+        requests[i].window = windows[i % std::size(windows)];
+        scheduler.Submit(requests[i]);
+    }
+
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        Wait(requests[i]);
+        const auto expected = ocra.TryVerify(parameters[i], responses[i], requests[i].window);
+        ASSERT_EQ(requests[i].result.status, expected.status) << "request " << i;
+        ASSERT_EQ(requests[i].result.isMatch, expected.isMatch) << "request " << i;
+        ASSERT_EQ(requests[i].result.offset, expected.offset) << "request " << i;
+    }
+    ASSERT_EQ(requests[11].result.status, 0x10);
+    ASSERT_EQ(requests[13].result.status, 0x15);
+    ASSERT_TRUE(requests[2].result);
+
+    const auto statistics = scheduler.Statistics();
+    ASSERT_EQ(statistics.requests, requests.size());
+    ASSERT_EQ(statistics.batches,
+              statistics.laneFlushes + statistics.batchFlushes + statistics.deadlineFlushes);
+    auto waits = uint64_t{};
+    for (const auto count : statistics.waits)
+        waits += count;
+    ASSERT_EQ(waits, requests.size());
+}
+
+TEST_F(BatchSchedulerTest, ShouldFlushFullLaneGroupBeforeDeadline)
+{
+    auto options = ocra::runtime::SchedulerOptions{};
+    options.maxWait = std::chrono::seconds(60);
+    auto scheduler = ocra::runtime::BatchScheduler(ocra, options);
+
+    // The lanes of the active kernel for the suite algorithm, not the widest ones
+    const auto lanes = ocra::hash::Lanes(static_cast<ocra::hash::Algorithm>(ocra.Suite().hmac));
+    auto requests = std::vector<ocra::runtime::VerifyRequest>(lanes);
+    for (auto i = 0u; i < requests.size(); ++i)
+    {
+        requests[i].parameters = parameters[i];
+        requests[i].response = responses[i];
+        scheduler.Submit(requests[i]);
+    }
+    for (const auto& request : requests)
+        Wait(request);
+
+    const auto statistics = scheduler.Statistics();
+    ASSERT_EQ(statistics.batches, 1u);
+    ASSERT_EQ(statistics.laneFlushes, 1u);
+    auto bucket = 0u;
+    while ((std::size_t{1} << bucket) < lanes)
+        ++bucket;
+    ASSERT_EQ(statistics.sizes[bucket], 1u);
+}
+
+TEST_F(BatchSchedulerTest, ShouldFlushAtDeadline)
+{
+    auto options = ocra::runtime::SchedulerOptions{};
+    options.maxWait = std::chrono::milliseconds(2);
+    auto scheduler = ocra::runtime::BatchScheduler(ocra, options);
+
+    auto request = ocra::runtime::VerifyRequest{};
+    request.parameters = parameters[0];
+    request.response = responses[0];
+    scheduler.Submit(request);
+    Wait(request);
+    ASSERT_TRUE(request.result);
+
+    const auto statistics = scheduler.Statistics();
+    ASSERT_EQ(statistics.deadlineFlushes, 1u);
+    ASSERT_GE(statistics.maxWaitNanoseconds, 2000000u);
+    ASSERT_GE(ocra::runtime::SchedulerStatistics::Quantile(statistics.waits, 0.99), 2048u);
+}
+
+TEST_F(BatchSchedulerTest, ShouldLimitBatchToMaxCandidates)
+{
+    auto options = ocra::runtime::SchedulerOptions{};
+    options.maxBatch = 8u;
+    options.maxWait = std::chrono::seconds(60);
+    options.isLaneFlush = false;
+
+    auto done = 0;
+    auto requests = std::vector<ocra::runtime::VerifyRequest>(10u);
+    {
+        auto scheduler = ocra::runtime::BatchScheduler(ocra, options);
+        for (auto i = 0u; i < requests.size(); ++i)
+        {
+            requests[i].parameters = parameters[i];
+            requests[i].response = responses[i];
+            requests[i].window = 1u;
+            requests[i].context = &done;
+            requests[i].done = [](ocra::runtime::VerifyRequest& request) { ++*static_cast<int*>(request.context); };
+            scheduler.Submit(requests[i]);
+        }
+
+        // Two candidates each, 4 of them wait for the destructor
+        while (scheduler.Statistics().batches < 2u)
+            std::this_thread::yield();
+        const auto statistics = scheduler.Statistics();
+        ASSERT_EQ(statistics.batchFlushes, 2u);
+        ASSERT_EQ(statistics.sizes[3], 2u);
+    }
+
+    ASSERT_EQ(done, 10);
+    for (auto i = 0u; i < requests.size(); ++i)
+        ASSERT_EQ(requests[i].result.isMatch, ocra.TryVerify(parameters[i], responses[i], 1u).isMatch);
+}
+
+TEST_F(BatchSchedulerTest, ShouldFailWindowPastLargestCounter)
+{
+    auto scheduler = ocra::runtime::BatchScheduler(ocra);
+    auto view = ocra::OcraParametersView(parameters[0]);
+    view.counter = UINT64_MAX - 1u;
+
+    auto request = ocra::runtime::VerifyRequest{};
+    request.parameters = view;
+    request.response = responses[0];
+    request.window = 2u;
+    scheduler.Submit(request);
+    Wait(request);
+    ASSERT_EQ(request.result.status, 0x28);
+}
+
+TEST(BatchSchedulerFailureTest, ShouldFailWindowOfSuiteWithoutCounter)
+{
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({ocra::OcraHmac::HOTP_SHA1});
+    auto scheduler = ocra::runtime::BatchScheduler(ocra::Ocra("OCRA-1:HOTP-SHA1-6:QN08"));
+    auto parameters = ocra::OcraParameters{};
+    parameters.key = std::vector<uint8_t>(20u, 0x31);
+    parameters.question = "00000000";
+
+    const auto response = std::string(scheduler.Suite().Compute(parameters).View());
+
+    auto request = ocra::runtime::VerifyRequest{};
+    request.parameters = parameters;
+    request.response = response;
+    request.window = 3u;
+    scheduler.Submit(request);
+    while (!request.IsDone())
+        std::this_thread::yield();
+    ASSERT_EQ(request.result.status, 0x21);
+
+    request.window = 0u;
+    scheduler.Submit(request);
+    while (!request.IsDone())
+        std::this_thread::yield();
+    ASSERT_TRUE(request.result);
+    mock::OcraHashFunction().SetAvailableHmacAlgorithm({});
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ocra/hex.hpp"
+#include "ocra/staticocra.hpp"
+#include "ocra/suiteparser.hpp"
+
+
+namespace
+{
+constexpr char SHA1_QN08[] = "OCRA-1:HOTP-SHA1-6:QN08";
+constexpr char SHA256_C_QN08_PSHA1[] = "OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1";
+constexpr char SHA512_QN08_T1M[] = "ocra-1:hotp-sha512-8:qn08-t1m";
+constexpr char SHA256_QA08[] = "OCRA-1:HOTP-SHA256-8:QA08";
+constexpr char SHA1_QH40_S064[] = "OCRA-1:HOTP-SHA1-10:QH40-S064";
+constexpr char SHA1_QN08_S001[] = "OCRA-1:HOTP-SHA1-6:QN08-S001";
+constexpr char SHA1_QN08_S003[] = "OCRA-1:HOTP-SHA1-6:QN08-S003";
+
+static_assert(ocra::ParseSuite(SHA1_QN08).status == 0);
+static_assert(ocra::ParseSuite(SHA512_QN08_T1M).suite.timestamp.Seconds() == 60u);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-6:C-QH64-PSHA256-S512-T48H").suite.sessionLength == 512u);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-6").status == 0x01);
+static_assert(ocra::ParseSuite("OCRA-2:HOTP-SHA1-6:QN08").status == 0x02);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-11:QN08").status == 0x06);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-6:QN65").status == 0x09);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-6:QN08-T60M").status == 0x0F);
+static_assert(ocra::ParseSuite("OCRA-1:HOTP-SHA1-6:QN08-X").status == 0x1E);
+
+static_assert(ocra::StaticOcra<SHA256_C_QN08_PSHA1>::Plan().questionOffset == 8u);
+static_assert(ocra::StaticOcra<SHA256_C_QN08_PSHA1>::Plan().length == 8u + 128u + 20u);
+static_assert(ocra::StaticOcra<SHA1_QH40_S064>::Plan().sessionOffset == 128u);
+
+
+constexpr auto _20_BYTES_KEY = "3132333435363738393031323334353637383930";
+constexpr auto _32_BYTES_KEY = "3132333435363738393031323334353637383930313233343536373839303132";
+constexpr auto _64_BYTES_KEY = "3132333435363738393031323334353637383930313233343536373839303132"
+                               "3334353637383930313233343536373839303132333435363738393031323334";
+
+ocra::OcraParameters Parameters(const char* key, std::string question)
+{
+    auto parameters = ocra::OcraParameters{};
+    ocra::DecodeHex(key, parameters.key);
+    parameters.question = std::move(question);
+    return parameters;
+}
+
+template <const char* SUITE>
+std::string Compute(const ocra::OcraParameters& parameters)
+{
+    using Static = ocra::StaticOcra<SUITE>;
+    return std::string(Static::Compute(parameters, Static::Prepare(parameters.key)).View());
+}
+
+// Status of the runtime validation, in the throwing build only whether it failed
+int RuntimeStatus(const std::string& suite)
+{
+    #ifdef OCRA_NO_THROW
+    return ocra::Ocra(suite).Status();
+    #else
+    try
+    {
+        ocra::Ocra{suite};
+        return 0;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return -1;
+    }
+    #endif
+}
+}  // namespace
+
+
+class StaticOcraParseTest : public ::testing::TestWithParam<std::string> {};
+
+INSTANTIATE_TEST_CASE_P(TestSuite, StaticOcraParseTest, ::testing::Values(
+    std::string{""},
+    std::string{":::"},
+    std::string{"OCRA-1:HOTP-SHA1-6"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08:"},
+    std::string{"OCRA-11:HOTP-SHA1-6:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-6-1:QN08"},
+    std::string{"OCRA-1:TOTP-SHA1-6:QN08"},
+    std::string{"OCRA-1:HOTP-SHA3-6:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-3:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-0:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-10:QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN8"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QX08"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN03"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN-1"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN 8"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN+8"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN6x"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-PSHA2"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-S12"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-S513"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-S-01"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-T1"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-T1D"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-T0S"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08-T99H"},
+    std::string{"OCRA-1:HOTP-SHA1-6:-QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-6:C--QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-6:C-PSHA1"},
+    std::string{"OCRA-1:HOTP-SHA1-6:CX-QN08"},
+    std::string{"OCRA-1:HOTP-SHA1-6:C-QN08-"},
+    std::string{"OCRA-1:HOTP-SHA1-6:C-QN08-T1M-PSHA1"},
+    std::string{"OCRA-1:HOTP-SHA1-6:C-QN08-PSHA1-S064-T1M-X"},
+    std::string{"ocra-1:hotp-sha512-8:c-qh64-psha512-s512-t48h"},
+    std::string{"OCRA-1:HOTP-SHA1-6:QN08\0-T1M", 28u}
+));
+
+TEST_P(StaticOcraParseTest, ShouldFailAsRuntimeValidation)
+{
+    const auto parsed = ocra::ParseSuite(GetParam());
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(parsed.status, RuntimeStatus(GetParam()));
+    #else
+    ASSERT_EQ(parsed.status != 0, RuntimeStatus(GetParam()) != 0);
+    #endif
+
+    if (!parsed.status)
+    {
+        ASSERT_EQ(parsed.suite.to_string(), ocra::Ocra(GetParam()).Suite().to_string());
+    }
+}
+
+TEST(StaticOcraTest, ShouldHaveLayoutOfRuntimeSuite)
+{
+    const auto runtime = ocra::Ocra(SHA1_QH40_S064);
+    const auto& expected = runtime.Plan();
+    const auto& plan = ocra::StaticOcra<SHA1_QH40_S064>::Plan();
+    ASSERT_EQ(plan.prefixLength, expected.prefixLength);
+    ASSERT_EQ(plan.questionOffset, expected.questionOffset);
+    ASSERT_EQ(plan.sessionOffset, expected.sessionOffset);
+    ASSERT_EQ(plan.sessionLength, expected.sessionLength);
+    ASSERT_EQ(plan.length, expected.length);
+    ASSERT_EQ(plan.assemble, expected.assemble);
+    ASSERT_EQ(plan.check, expected.check);
+    ASSERT_EQ(plan.write, expected.write);
+}
+
+TEST(StaticOcraTest, ShouldGenerateProperValues)
+{
+    ASSERT_EQ(Compute<SHA1_QN08>(Parameters(_20_BYTES_KEY, "00000000")), "237653");
+    ASSERT_EQ(Compute<SHA1_QN08>(Parameters(_20_BYTES_KEY, "99999999")), "294470");
+
+    auto counted = Parameters(_32_BYTES_KEY, "12345678");
+    counted.password = "1234";
+    counted.counter = 9u;
+    ASSERT_EQ(Compute<SHA256_C_QN08_PSHA1>(counted), "08522129");
+
+    auto timed = Parameters(_64_BYTES_KEY, "22222222");
+    timed.timestamp = 0x132d0b6;
+    ASSERT_EQ(Compute<SHA512_QN08_T1M>(timed), "22048402");
+
+    ASSERT_EQ(Compute<SHA256_QA08>(Parameters(_32_BYTES_KEY, "SIG13000")), "76028668");
+}
+
+TEST(StaticOcraTest, ShouldGenerateValuesOfRuntimeSuite)
+{
+    auto parameters = Parameters(_20_BYTES_KEY, "0123456789abcdef0123456789ABCDEF01234567");
+    parameters.sessionInfo = std::string(128u, 'a');
+
+    const auto runtime = ocra::Ocra(SHA1_QH40_S064);
+    const auto result = runtime.Compute(parameters, runtime.Prepare(parameters.key));
+    ASSERT_EQ(Compute<SHA1_QH40_S064>(parameters), result.View());
+
+    // Keys prepared by either one are accepted by the other
+    using Static = ocra::StaticOcra<SHA1_QH40_S064>;
+    ASSERT_EQ(runtime.Compute(parameters, Static::Prepare(parameters.key)).View(), result.View());
+    ASSERT_EQ(Static::Compute(parameters, runtime.Prepare(parameters.key)).View(), result.View());
+}
+
+TEST(StaticOcraTest, ShouldKeepOddSessionInfoInsideItsField)
+{
+    auto parameters = Parameters(_20_BYTES_KEY, "12345678");
+    parameters.sessionInfo = "A";
+    const auto single = ocra::Ocra(SHA1_QN08_S001);
+    ASSERT_EQ(Compute<SHA1_QN08_S001>(parameters), single.Compute(parameters, single.Prepare(parameters.key)).View());
+
+    parameters.sessionInfo = "ABC";
+    const auto triple = ocra::Ocra(SHA1_QN08_S003);
+    ASSERT_EQ(Compute<SHA1_QN08_S003>(parameters), triple.Compute(parameters, triple.Prepare(parameters.key)).View());
+
+    parameters.sessionInfo.reset();
+    parameters.sessionInfoBytes = std::vector<uint8_t>{0x00, 0xAB, 0xC0};
+    ASSERT_EQ(Compute<SHA1_QN08_S003>(parameters), triple.Compute(parameters, triple.Prepare(parameters.key)).View());
+}
+
+TEST(StaticOcraTest, ShouldFailAsRuntimeSuite)
+{
+    using Static = ocra::StaticOcra<SHA256_C_QN08_PSHA1>;
+    auto parameters = Parameters(_32_BYTES_KEY, "12345678");
+    parameters.password = "1234";
+    const auto key = Static::Prepare(parameters.key);
+
+    #ifdef OCRA_NO_THROW
+    ASSERT_EQ(Static::Compute(parameters, key).status, 0x12);
+    ASSERT_EQ(Static::Compute(parameters, Static::Prepare({})).status, 0x10);
+    ASSERT_EQ(Static::Compute(parameters, ocra::StaticOcra<SHA1_QN08>::Prepare(parameters.key)).status, 0x1F);
+    #else
+    ASSERT_THROW(Static::Compute(parameters, key), std::invalid_argument);
+    #endif
+}
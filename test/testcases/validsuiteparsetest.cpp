@@ -71,3 +71,29 @@ TEST_P(OcraValidSuiteParseTest, ShouldParseAndReturnTheSameSuite)
 
     ASSERT_EQ(ocra.Suite().to_string(), ocraSuite);
 }
+
+TEST(OcraEvaluationPlanTest, ShouldCompileFixedMessageLayout)
+{
+    auto ocra = ocra::Ocra{"OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1-S064-T1M"};
+    const auto& plan = ocra.Plan();
+
+    ASSERT_NE(plan.assemble, nullptr);
+    ASSERT_EQ(plan.prefixLength, 43u);
+    ASSERT_EQ(plan.counterOffset, 0u);
+    ASSERT_EQ(plan.questionOffset, 8u);
+    ASSERT_EQ(plan.passwordOffset, 136u);
+    ASSERT_EQ(plan.sessionOffset, 156u);
+    ASSERT_EQ(plan.timestampOffset, 220u);
+    ASSERT_EQ(plan.length, 228u);
+}
+
+TEST(OcraEvaluationPlanTest, ShouldRecompileOnSuiteChange)
+{
+    auto ocra = ocra::Ocra{"OCRA-1:HOTP-SHA256-8:C-QN08-PSHA1"};
+    ocra.From("OCRA-1:HOTP-SHA1-6:QN08");
+
+    ASSERT_FALSE(ocra.Suite().isCounter);
+    ASSERT_EQ(ocra.Suite().passwordSha, ocra::OcraSha::None);
+    ASSERT_EQ(ocra.Plan().questionOffset, 0u);
+    ASSERT_EQ(ocra.Plan().length, 128u);
+}